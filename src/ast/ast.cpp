@@ -251,6 +251,95 @@ typename ::std::vector<Named<T> >::const_iterator find_named(const ::std::vector
     });
 }
 
+namespace {
+    typedef ::std::unordered_map< ::std::string, Module::IndexEnt >    t_index;
+    
+    /// Chain of modules being searched (to stop on glob import cycles)
+    struct GlobStack {
+        const Module*   mod;
+        const GlobStack*    prev;
+        
+        bool contains(const Module* m) const {
+            for(const auto* e = this; e; e = e->prev)
+                if( e->mod == m )
+                    return true;
+            return false;
+        }
+    };
+    
+    /// Search the glob imports of `mod` for `name` (looking in `index` of each imported module)
+    /// - Only public items (and public globs) of the imported modules are visible, and a private item shadows any glob.
+    const Module::IndexEnt* find_glob_item(const Module& mod, t_index Module::* index, const ::std::string& name, bool pub_only, const GlobStack& stack)
+    {
+        for(const auto& glob : mod.m_glob_imports)
+        {
+            if( pub_only && !glob.is_pub )
+                continue ;
+            if( stack.contains(glob.module) )
+                continue ;
+            const auto& src_index = glob.module->*index;
+            auto it = src_index.find(name);
+            if( it != src_index.end() ) {
+                if( it->second.is_pub )
+                    return &it->second;
+                continue ;
+            }
+            
+            GlobStack   inner { glob.module, &stack };
+            if( const auto* rv = find_glob_item(*glob.module, index, name, true, inner) )
+                return rv;
+        }
+        return nullptr;
+    }
+    const Module::IndexEnt* find_index_item(const Module& mod, const t_index& own_index, t_index Module::* glob_index, const ::std::string& name)
+    {
+        auto it = own_index.find(name);
+        if( it != own_index.end() )
+            return &it->second;
+        if( mod.m_glob_imports.empty() )
+            return nullptr;
+        return find_glob_item(mod, glob_index, name, false, GlobStack { &mod, nullptr });
+    }
+    
+    void visit_glob_items(const Module& mod, const Module& glob_mod, bool pub_only, const GlobStack& stack, FunctionRef<void(const ::std::string&, const Module::IndexEnt&)> cb)
+    {
+        for(const auto& glob : glob_mod.m_glob_imports)
+        {
+            if( pub_only && !glob.is_pub )
+                continue ;
+            if( stack.contains(glob.module) )
+                continue ;
+            for(const auto& ent : glob.module->m_type_items)
+            {
+                // Only visit the entry that a lookup would return
+                if( ent.second.is_pub && mod.find_type_item(ent.first) == &ent.second ) {
+                    cb(ent.first, ent.second);
+                }
+            }
+            GlobStack   inner { glob.module, &stack };
+            visit_glob_items(mod, *glob.module, true, inner, cb);
+        }
+    }
+}
+
+// NOTE: Glob imported types are also visible in the namespace index (matching `use foo::Bar`)
+const Module::IndexEnt* Module::find_namespace_item(const ::std::string& name) const
+{
+    return find_index_item(*this, m_namespace_items, &Module::m_type_items, name);
+}
+const Module::IndexEnt* Module::find_type_item(const ::std::string& name) const
+{
+    return find_index_item(*this, m_type_items, &Module::m_type_items, name);
+}
+const Module::IndexEnt* Module::find_value_item(const ::std::string& name) const
+{
+    return find_index_item(*this, m_value_items, &Module::m_value_items, name);
+}
+void Module::visit_glob_type_items(FunctionRef<void(const ::std::string&, const IndexEnt&)> cb) const
+{
+    visit_glob_items(*this, *this, false, GlobStack { this, nullptr }, cb);
+}
+
 Module::ItemRef Module::find_item(const ::std::string& needle, bool allow_leaves, bool ignore_private_wildcard) const
 {
     TRACE_FUNCTION_F("path = " << m_my_path << ", needle = " << needle);
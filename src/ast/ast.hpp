@@ -28,6 +28,7 @@
 #include <ast/macro.hpp>
 
 #include "generics.hpp"
+#include <function_ref.hpp>
 
 #include <macro_rules/macro_rules_ptr.hpp>
 
@@ -48,8 +49,7 @@ enum eItemType
     ITEM_FN,
 };
 
-struct StructItem:
-    public Serialisable
+struct StructItem
 {
     ::AST::MetaItems    m_attrs;
     bool    m_is_public;
@@ -75,8 +75,7 @@ struct StructItem:
     SERIALISABLE_PROTOTYPES();
 };
 
-struct TupleItem:
-    public Serialisable
+struct TupleItem
 {
     ::AST::MetaItems    m_attrs;
     bool    m_is_public;
@@ -100,8 +99,7 @@ struct TupleItem:
     SERIALISABLE_PROTOTYPES();
 };
 
-class TypeAlias:
-    public Serialisable
+class TypeAlias
 {
     GenericParams  m_params;
     TypeRef m_type;
@@ -121,8 +119,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-class Static:
-    public Serialisable
+class Static
 {
 public:
     enum Class
@@ -155,8 +152,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-class Function:
-    public Serialisable
+class Function
 {
 public:
     typedef ::std::vector< ::std::pair<AST::Pattern,TypeRef> >   Arglist;
@@ -196,8 +192,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-class Trait:
-    public Serialisable
+class Trait
 {
     GenericParams  m_params;
     ::std::vector< Spanned<AST::Path> > m_supertraits;
@@ -235,7 +230,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-TAGGED_UNION_EX(EnumVariantData, (: public Serialisable), Value,
+TAGGED_UNION_EX(EnumVariantData, (), Value,
     (
     (Value, struct {
         ::AST::Expr m_value;
@@ -254,8 +249,7 @@ TAGGED_UNION_EX(EnumVariantData, (: public Serialisable), Value,
     )
     );
 
-struct EnumVariant:
-    public Serialisable
+struct EnumVariant
 {
     MetaItems   m_attrs;
     ::std::string   m_name;
@@ -306,8 +300,7 @@ struct EnumVariant:
     SERIALISABLE_PROTOTYPES();
 };
 
-class Enum:
-    public Serialisable
+class Enum
 {
     GenericParams    m_params;
     ::std::vector<EnumVariant>   m_variants;
@@ -327,7 +320,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-TAGGED_UNION_EX(StructData, (: public Serialisable), Struct,
+TAGGED_UNION_EX(StructData, (), Struct,
     (
     (Tuple, struct {
         ::std::vector<TupleItem>    ents;
@@ -343,8 +336,7 @@ TAGGED_UNION_EX(StructData, (: public Serialisable), Struct,
         )
     );
 
-class Struct:
-    public Serialisable
+class Struct
 {
     GenericParams    m_params;
 public:
@@ -368,8 +360,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-class ImplDef:
-    public Serialisable
+class ImplDef
 {
     Span    m_span;
     MetaItems   m_attrs;
@@ -404,8 +395,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-class Impl:
-    public Serialisable
+class Impl
 {
 public:
     struct ImplItem {
@@ -427,6 +417,8 @@ private:
     
 public:
     ::std::vector<MacroInvocation>    m_macro_invocations;
+    /// Cleared by the early expand pass if nothing in this impl was left for the late pass
+    bool    late_expand_pending = true;
     
     Impl() {}
     Impl(Impl&&) /*noexcept*/ = default;
@@ -455,8 +447,7 @@ public:
 private:
 };
 
-struct UseStmt:
-    public Serialisable
+struct UseStmt
 {
     Span    sp;
     ::AST::Path path;
@@ -476,8 +467,7 @@ struct UseStmt:
 };
 
 /// Representation of a parsed (and being converted) function
-class Module:
-    public Serialisable
+class Module
 {
 public:
     class ItemRef
@@ -574,6 +564,13 @@ public:
     ::std::unordered_map< ::std::string, IndexEnt >    m_namespace_items;
     ::std::unordered_map< ::std::string, IndexEnt >    m_type_items;
     ::std::unordered_map< ::std::string, IndexEnt >    m_value_items;
+    /// Modules glob imported (`use foo::*`) by this module, searched (in order) if a name isn't in the above
+    /// - Public globs are first, matching the order they were indexed.
+    struct GlobImport {
+        bool is_pub;
+        const Module*   module;
+    };
+    ::std::vector<GlobImport>   m_glob_imports;
 
 public:
     Module() {}
@@ -628,6 +625,14 @@ public:
     }
 
     const ::AST::Path& path() const { return m_my_path; }
+    
+    /// Look up a name in the index, including names brought in by glob imports
+    const IndexEnt* find_namespace_item(const ::std::string& name) const;
+    const IndexEnt* find_type_item(const ::std::string& name) const;
+    const IndexEnt* find_value_item(const ::std::string& name) const;
+    /// Enumerate the type items brought in by glob imports (skipping any that are shadowed)
+    void visit_glob_type_items(FunctionRef<void(const ::std::string&, const IndexEnt&)> cb) const;
+    
     ItemRef find_item(const ::std::string& needle, bool allow_leaves = true, bool ignore_private_wildcard = true) const;
 
           ::std::vector<Named<Item>>& items()       { return m_items; }
@@ -658,7 +663,7 @@ private:
 };
 
 
-TAGGED_UNION_EX(Item, (: public Serialisable), None,
+TAGGED_UNION_EX(Item, (), None,
     (
     (None, struct {} ),
     (Module, Module),
@@ -675,11 +680,13 @@ TAGGED_UNION_EX(Item, (: public Serialisable), None,
     (Static, Static)
     ),
     
-    (, attrs(mv$(x.attrs))), (attrs = mv$(x.attrs);),
+    (, attrs(mv$(x.attrs)), late_expand_pending(x.late_expand_pending)), (attrs = mv$(x.attrs); late_expand_pending = x.late_expand_pending;),
     (
     public:
         MetaItems   attrs;
         Span    span;
+        /// Cleared by the early expand pass if nothing in this item (attributes or macros) was left for the late pass
+        bool    late_expand_pending = true;
         
         SERIALISABLE_PROTOTYPES();
     )
@@ -7,8 +7,7 @@ namespace AST {
 //
 class MetaItem;
 
-class MetaItems:
-    public Serialisable
+class MetaItems
 {
 public:
     Span    m_span;
@@ -52,8 +51,7 @@ TAGGED_UNION(MetaItemData, None,
         })
     );
 
-class MetaItem:
-    public Serialisable
+class MetaItem
 {
     ::std::string   m_name;
     MetaItemData    m_data;
@@ -9,8 +9,7 @@ namespace AST {
 
 class ExternCrate;
 
-class Crate:
-    public Serialisable
+class Crate
 {
 public:
     ::std::map< TypeRef, ::std::vector<Impl*> >  m_impl_map;
@@ -53,8 +52,7 @@ public:
 
 /// Representation of an imported crate
 /// - Functions are stored as resolved+typechecked ASTs
-class ExternCrate:
-    public Serialisable
+class ExternCrate
 {
     ::std::map< ::std::string, MacroRulesPtr > m_mr_macros;
     
@@ -50,7 +50,7 @@ public:
     void visit(NodeVisitor& nv) override;\
     void print(::std::ostream& os) const override; \
     ::std::unique_ptr<ExprNode> clone() const override; \
-    SERIALISABLE_PROTOTYPES();
+    SERIALISABLE_OVERRIDES();
 
 struct ExprNode_Block:
     public ExprNode
@@ -237,8 +237,7 @@ struct ExprNode_Loop:
     NODE_METHODS();
 };
 
-struct ExprNode_Match_Arm:
-    public Serialisable
+struct ExprNode_Match_Arm
 {
     MetaItems   m_attrs;
     ::std::vector<Pattern>  m_patterns;
@@ -686,8 +685,7 @@ public:
     #undef NT
 };
 
-class Expr:
-    public Serialisable
+class Expr
 {
     ::std::shared_ptr<ExprNode> m_node;
 public:
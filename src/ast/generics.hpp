@@ -6,8 +6,7 @@
 namespace AST {
 
 
-class TypeParam:
-    public Serialisable
+class TypeParam
 {
     ::std::string   m_name;
     TypeRef m_default;
@@ -30,7 +29,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-TAGGED_UNION_EX( GenericBound, (: public Serialisable), Lifetime,
+TAGGED_UNION_EX( GenericBound, (), Lifetime,
     (
     // Lifetime bound: 'test must be valid for 'bound
     (Lifetime, struct {
@@ -88,8 +87,7 @@ TAGGED_UNION_EX( GenericBound, (: public Serialisable), Lifetime,
 
 ::std::ostream& operator<<(::std::ostream& os, const GenericBound& x);
 
-class GenericParams:
-    public Serialisable
+class GenericParams
 {
     ::std::vector<TypeParam>    m_type_params;
     ::std::vector< ::std::string > m_lifetime_params;
@@ -32,8 +32,7 @@ struct NamedNS
 
 template <typename T>
 struct Named:
-    public NamedNS<T>,
-    public Serialisable
+    public NamedNS<T>
 {
     Named():
         NamedNS<T>()
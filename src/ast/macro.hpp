@@ -8,8 +8,7 @@
 
 namespace AST {
 
-class MacroInvocation:
-    public Serialisable
+class MacroInvocation
 {
     Span    m_span;
     
@@ -97,8 +97,7 @@ struct PathParams
     friend ::std::ostream& operator<<(::std::ostream& os, const PathParams& x);
 };
 
-class PathNode:
-    public ::Serialisable
+class PathNode
 {
     ::std::string   m_name;
     PathParams  m_params;
@@ -119,8 +118,7 @@ public:
     SERIALISABLE_PROTOTYPES();
 };
 
-class Path:
-    public ::Serialisable
+class Path
 {
 public:
     TAGGED_UNION(Class, Invalid,
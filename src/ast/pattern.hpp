@@ -42,8 +42,7 @@ public:
     bool is_valid() const { return m_name != ""; }
 };
 
-class Pattern:
-    public Serialisable
+class Pattern
 {
 public:
     TAGGED_UNION(Value, Invalid,
@@ -35,8 +35,7 @@ struct TypeArgRef
     const AST::GenericParams*  params;
 };
 
-struct Type_Function:
-    public Serialisable
+struct Type_Function
 {
     bool    is_unsafe;
     ::std::string   m_abi;
@@ -100,8 +99,7 @@ TAGGED_UNION(TypeData, None,
     );
 
 /// A type
-class TypeRef:
-    public Serialisable
+class TypeRef
 {
     Span    m_span;
 public:
@@ -0,0 +1,167 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * batch.cpp
+ * - Batch mode (compiles a list of independent crates in one invocation)
+ *
+ * Each crate is compiled in a child forked from this process, so setup done before the batch is shared by all of them.
+ * Processes are used (rather than compiling crates on threads) because the compiler holds per-crate state in globals
+ * (e.g. the current phase, the loaded crates and caches) that would otherwise have to be reset between crates, the
+ * crate's output has to be redirected to its log via the process's stdout/stderr, and a crate that aborts or crashes
+ * only fails its own entry.
+ */
+#include <batch.hpp>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+namespace {
+    typedef ::std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        ::std::string   infile;
+        ::std::string   outfile;
+
+        /// Set once the compile has finished (false if it couldn't be started)
+        bool    finished = false;
+        /// Wait status of the compile
+        int     status = 0;
+        Clock::time_point   start;
+        double  time = 0;
+    };
+
+    /// Create the directories leading to `path` (if they don't already exist)
+    void make_parent_dirs(const ::std::string& path)
+    {
+        for(auto pos = path.find('/', 1); pos != ::std::string::npos; pos = path.find('/', pos + 1))
+        {
+            ::mkdir(path.substr(0, pos).c_str(), 0777);
+        }
+    }
+
+    /// Compile one crate (called in the forked child), with all output going to the crate's log file
+    int run_entry(const Entry& ent, FunctionRef<int(const char*, const char*)> compile)
+    {
+        make_parent_dirs(ent.outfile);
+        auto log_path = ent.outfile + ".txt";
+        int fd = ::open(log_path.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0666);
+        if( fd < 0 ) {
+            ::std::cerr << "Unable to open " << log_path << ": " << strerror(errno) << ::std::endl;
+            return 1;
+        }
+        ::dup2(fd, 1);
+        ::dup2(fd, 2);
+        ::close(fd);
+        return compile(ent.infile.c_str(), ent.outfile.c_str());
+    }
+}
+
+int Batch_Run(const char* list_path, unsigned int max_jobs, FunctionRef<int(const char* infile, const char* outfile)> compile)
+{
+    ::std::vector<Entry>    entries;
+    {
+        ::std::ifstream is(list_path);
+        if( !is.is_open() ) {
+            ::std::cerr << "Unable to open batch list " << list_path << ::std::endl;
+            return 1;
+        }
+        ::std::string   line;
+        while( ::std::getline(is, line) )
+        {
+            ::std::istringstream    ss(line);
+            Entry   ent;
+            if( !(ss >> ent.infile) || ent.infile[0] == '#' )
+                continue ;
+            if( !(ss >> ent.outfile) )
+                ent.outfile = ent.infile + ".o";
+            entries.push_back( ::std::move(ent) );
+        }
+    }
+
+    auto batch_start = Clock::now();
+    max_jobs = ::std::max(1u, max_jobs);
+    // PID of each running compile, to its index in `entries`
+    ::std::map<pid_t, size_t>   running;
+    size_t  next = 0;
+    while( next < entries.size() || !running.empty() )
+    {
+        // Start compiles until all job slots are in use
+        while( next < entries.size() && running.size() < max_jobs )
+        {
+            auto idx = next ++;
+            // Flush before forking, so buffered output isn't duplicated into the child
+            ::std::cout.flush();
+            ::fflush(nullptr);
+            entries[idx].start = Clock::now();
+            auto pid = ::fork();
+            if( pid == 0 )
+            {
+                int rv = run_entry(entries[idx], compile);
+                ::std::cout.flush();
+                ::std::cerr.flush();
+                ::fflush(nullptr);
+                ::_exit(rv);
+            }
+            if( pid < 0 ) {
+                ::std::cerr << "Unable to fork for " << entries[idx].infile << ": " << strerror(errno) << ::std::endl;
+                continue ;
+            }
+            running.insert( ::std::make_pair(pid, idx) );
+        }
+        if( running.empty() )
+            break;
+
+        int status = 0;
+        auto pid = ::waitpid(-1, &status, 0);
+        if( pid < 0 ) {
+            if( errno == EINTR )
+                continue ;
+            ::std::cerr << "Waiting for compiles failed: " << strerror(errno) << ::std::endl;
+            return 1;
+        }
+        auto it = running.find(pid);
+        if( it == running.end() )
+            continue ;
+        auto& ent = entries[it->second];
+        ent.finished = true;
+        ent.status = status;
+        ent.time = ::std::chrono::duration<double>(Clock::now() - ent.start).count();
+        running.erase(it);
+    }
+    double total_time = ::std::chrono::duration<double>(Clock::now() - batch_start).count();
+
+    // Summary (in list order)
+    size_t  n_pass = 0;
+    for(const auto& ent : entries)
+    {
+        bool pass = ent.finished && WIFEXITED(ent.status) && WEXITSTATUS(ent.status) == 0;
+        ::std::cout << (pass ? "PASS" : "FAIL") << " (" << ::std::fixed << ::std::setprecision(2) << ent.time << " s) " << ent.infile;
+        if( !ent.finished )
+            ::std::cout << " - not run";
+        else if( WIFSIGNALED(ent.status) )
+            ::std::cout << " - killed by signal " << WTERMSIG(ent.status);
+        else if( !pass )
+            ::std::cout << " - exit code " << WEXITSTATUS(ent.status);
+        ::std::cout << ::std::endl;
+        if( pass )
+            n_pass ++;
+    }
+    ::std::cout << "Batch: " << n_pass << " passed, " << (entries.size() - n_pass) << " failed"
+        << " (" << ::std::fixed << ::std::setprecision(2) << total_time << " s)" << ::std::endl;
+    return n_pass == entries.size() ? 0 : 1;
+}
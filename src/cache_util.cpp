@@ -0,0 +1,35 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * cache_util.cpp
+ * - Helpers shared by the on-disk caches (parse and typecheck)
+ */
+#include <cache_util.hpp>
+#include <fstream>
+#include <sstream>
+
+CacheHash hash_buffer(const ::std::string& buf)
+{
+    uint64_t    h1 = 0xcbf29ce484222325ULL;
+    uint64_t    h2 = buf.size();
+    for(unsigned char c : buf)
+    {
+        h1 ^= c;
+        h1 *= 0x100000001b3ULL;
+        h2 = (h2 + c) * 0x9E3779B97F4A7C15ULL;
+        h2 ^= h2 >> 29;
+    }
+    return CacheHash(h1, h2);
+}
+
+bool read_file(const ::std::string& path, ::std::string& out)
+{
+    ::std::ifstream is(path, ::std::ios::binary);
+    if( !is.is_open() )
+        return false;
+    ::std::stringstream ss;
+    ss << is.rdbuf();
+    out = ss.str();
+    return true;
+}
@@ -7,28 +7,98 @@
 
 #include <map>
 #include <set>
+#include <unordered_map>
 
 ::std::map< ::std::string, ::std::string>   g_cfg_values;
 ::std::map< ::std::string, ::std::function<bool(const ::std::string&)> >   g_cfg_value_fcns;
 ::std::set< ::std::string >   g_cfg_flags;
 
+namespace {
+    /// Interned cfg names, used to build the canonical form of a predicate
+    ::std::unordered_map< ::std::string, unsigned int>  g_cfg_name_ids;
+    /// Result of each distinct predicate (keyed on its canonical form)
+    ::std::unordered_map< ::std::string, bool>  g_cfg_results;
+    
+    /// Set if the last evaluation warned about an unknown cfg (so the result shouldn't be cached)
+    bool    g_cfg_warned = false;
+}
+
 void Cfg_SetFlag(::std::string name) {
     g_cfg_flags.insert( mv$(name) );
+    g_cfg_results.clear();
 }
 void Cfg_SetValue(::std::string name, ::std::string val) {
     g_cfg_values.insert( ::std::make_pair(mv$(name), mv$(val)) );
+    g_cfg_results.clear();
 }
 void Cfg_SetValueCb(::std::string name, ::std::function<bool(const ::std::string&)> cb) {
     g_cfg_value_fcns.insert( ::std::make_pair(mv$(name), mv$(cb)) );
+    g_cfg_results.clear();
 }
 
-bool check_cfg(Span sp, const ::AST::MetaItem& mi) {
+namespace {
+    void push_uint(::std::string& out, unsigned int v) {
+        while( v >= 0x80 ) {
+            out += static_cast<char>(0x80 | (v & 0x7F));
+            v >>= 7;
+        }
+        out += static_cast<char>(v);
+    }
+    
+    /// Build the canonical form of a cfg predicate
+    /// - Operators are a single byte followed by the operand count, names are replaced by their interned ID
+    /// - Malformed operators (unknown functions, `not` with != 1 argument) aren't errors here, as they're only reported
+    ///   if evaluation reaches them (e.g. `any(unix, bogus(x))` is true on unix without an error)
+    void cfg_compile(const Span& sp, const ::AST::MetaItem& mi, ::std::string& out)
+    {
+        if( mi.has_sub_items() ) {
+            if( mi.name() == "any" || mi.name() == "cfg" ) {
+                out += '|';
+            }
+            else if( mi.name() == "not" ) {
+                // NOTE: The operand count is part of the key, so a bad `not` can't share a result with a valid one
+                out += '!';
+            }
+            else if( mi.name() == "all" ) {
+                out += '&';
+            }
+            else {
+                // Unknown function, keyed on its name (the error is raised by `check_cfg_uncached` if it's evaluated)
+                out += '@';
+                push_uint(out, mi.name().size());
+                out += mi.name();
+            }
+            push_uint(out, mi.items().size());
+            for(const auto& si : mi.items()) {
+                cfg_compile(sp, si, out);
+            }
+        }
+        else {
+            auto it = g_cfg_name_ids.find( mi.name() );
+            if( it == g_cfg_name_ids.end() ) {
+                it = g_cfg_name_ids.insert( ::std::make_pair(mi.name(), static_cast<unsigned int>(g_cfg_name_ids.size())) ).first;
+            }
+            if( mi.has_string() ) {
+                out += '=';
+                push_uint(out, it->second);
+                push_uint(out, mi.string().size());
+                out += mi.string();
+            }
+            else {
+                out += '?';
+                push_uint(out, it->second);
+            }
+        }
+    }
+}
+
+bool check_cfg_uncached(const Span& sp, const ::AST::MetaItem& mi) {
     
     if( mi.has_sub_items() ) {
         // Must be `any`/`not`/`all`
         if( mi.name() == "any" || mi.name() == "cfg" ) {
             for(const auto& si : mi.items()) {
-                if( check_cfg(sp, si) )
+                if( check_cfg_uncached(sp, si) )
                     return true;
             }
             return false;
@@ -36,11 +106,11 @@ bool check_cfg(Span sp, const ::AST::MetaItem& mi) {
         else if( mi.name() == "not" ) {
             if( mi.items().size() != 1 )
                 ERROR(sp, E0000, "cfg(not()) with != 1 argument");
-            return !check_cfg(sp, mi.items()[0]);
+            return !check_cfg_uncached(sp, mi.items()[0]);
         }
         else if( mi.name() == "all" ) {
             for(const auto& si : mi.items()) {
-                if( ! check_cfg(sp, si) )
+                if( ! check_cfg_uncached(sp, si) )
                     return false;
             }
             return true;
@@ -67,6 +137,7 @@ bool check_cfg(Span sp, const ::AST::MetaItem& mi) {
         }
         
         WARNING(sp, W0000, "Unknown cfg() param '" << mi.name() << "'");
+        g_cfg_warned = true;
         return false;
     }
     else {
@@ -76,6 +147,23 @@ bool check_cfg(Span sp, const ::AST::MetaItem& mi) {
     }
     BUG(sp, "Fell off the end of check_cfg");
 }
+bool check_cfg(Span sp, const ::AST::MetaItem& mi) {
+    ::std::string   key;
+    cfg_compile(sp, mi, key);
+    
+    auto it = g_cfg_results.find(key);
+    if( it != g_cfg_results.end() ) {
+        return it->second;
+    }
+    
+    g_cfg_warned = false;
+    bool rv = check_cfg_uncached(sp, mi);
+    // - Predicates with unknown names are re-evaluated each time, so every use gets its warning
+    if( !g_cfg_warned ) {
+        g_cfg_results.insert( ::std::make_pair(mv$(key), rv) );
+    }
+    return rv;
+}
 
 class CCfgExpander:
     public ExpandProcMacro
@@ -5,13 +5,14 @@
 #include <main_bindings.hpp>
 #include <synext.hpp>
 #include <map>
+#include <unordered_map>
 #include "macro_rules.hpp"
 #include "../parse/common.hpp"  // For reparse from macros
 #include <ast/expr.hpp>
 #include "cfg.hpp"
 
-::std::map< ::std::string, ::std::unique_ptr<ExpandDecorator> >  g_decorators;
-::std::map< ::std::string, ::std::unique_ptr<ExpandProcMacro> >  g_macros;
+::std::unordered_map< ::std::string, ::std::unique_ptr<ExpandDecorator> >  g_decorators;
+::std::unordered_map< ::std::string, ::std::unique_ptr<ExpandProcMacro> >  g_macros;
 
 void Expand_Attrs(const ::AST::MetaItems& attrs, AttrStage stage,  ::std::function<void(const ExpandDecorator& d,const ::AST::MetaItem& a)> f);
 void Expand_Mod(bool is_early, ::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::Path modpath, ::AST::Module& mod);
@@ -38,16 +39,27 @@ namespace {
     AttrStage stage_post(bool is_early) {
         return (is_early ? AttrStage::EarlyPost : AttrStage::LatePost);
     }
+    bool is_early_stage(AttrStage stage) {
+        return stage == AttrStage::EarlyPre || stage == AttrStage::EarlyPost;
+    }
+    
+    /// Number of attributes and macro invocations the early pass has seen that need the late pass
+    /// - Compared before/after each item to tell if the late pass needs to visit it.
+    unsigned int    g_late_work_count = 0;
 }
 
 void Expand_Attr(const Span& sp, const ::AST::MetaItem& a, AttrStage stage,  ::std::function<void(const Span& sp, const ExpandDecorator& d,const ::AST::MetaItem& a)> f)
 {
-    for( auto& d : g_decorators ) {
-        if( d.first == a.name() ) {
-            DEBUG("#[" << d.first << "] " << (int)d.second->stage() << "-" << (int)stage);
-            if( d.second->stage() == stage ) {
-                f(sp, *d.second, a);
-            }
+    auto it = g_decorators.find( a.name() );
+    if( it != g_decorators.end() )
+    {
+        const auto& d = *it->second;
+        DEBUG("#[" << it->first << "] " << (int)d.stage() << "-" << (int)stage);
+        if( d.stage() == stage ) {
+            f(sp, d, a);
+        }
+        else if( is_early_stage(stage) && !is_early_stage(d.stage()) ) {
+            g_late_work_count += 1;
         }
     }
 }
@@ -74,20 +86,16 @@ void Expand_Attrs(const ::AST::MetaItems& attrs, AttrStage stage,  ::AST::Crate&
     Expand_Attrs(attrs, stage,  [&](const auto& sp, const auto& d, const auto& a){ d.handle(sp, a, crate, mod, impl); });
 }
 
-::std::unique_ptr<TokenStream> Expand_Macro(
+::std::unique_ptr<TokenStream> Expand_Macro_Inner(
     bool is_early, const ::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::Module& mod,
     Span mi_span, const ::std::string& name, const ::std::string& input_ident, const TokenTree& input_tt
     )
 {
-    if( name == "" ) {
-        return ::std::unique_ptr<TokenStream>();
-    }
-    
-    for( const auto& m : g_macros )
     {
-        if( name == m.first && m.second->expand_early() == is_early )
+        auto it = g_macros.find(name);
+        if( it != g_macros.end() && it->second->expand_early() == is_early )
         {
-            auto e = m.second->expand(mi_span, crate, input_ident, input_tt, mod);
+            auto e = it->second->expand(mi_span, crate, input_ident, input_tt, mod);
             return e;
         }
     }
@@ -131,6 +139,22 @@ void Expand_Attrs(const ::AST::MetaItems& attrs, AttrStage stage,  ::AST::Crate&
     // Leave valid and return an empty expression
     return ::std::unique_ptr<TokenStream>();
 }
+::std::unique_ptr<TokenStream> Expand_Macro(
+    bool is_early, const ::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::Module& mod,
+    Span mi_span, const ::std::string& name, const ::std::string& input_ident, const TokenTree& input_tt
+    )
+{
+    if( name == "" ) {
+        return ::std::unique_ptr<TokenStream>();
+    }
+    
+    auto rv = Expand_Macro_Inner(is_early, crate, modstack, mod,  mi_span, name, input_ident, input_tt);
+    if( is_early && !rv ) {
+        // Not expanded, so left for the late pass
+        g_late_work_count += 1;
+    }
+    return rv;
+}
 ::std::unique_ptr<TokenStream> Expand_Macro(bool is_early, const ::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::Module& mod, const ::AST::MacroInvocation& mi)
 {
     return Expand_Macro(is_early, crate, modstack, mod,  mi.span(), mi.name(), mi.input_ident(), mi.input_tt());
@@ -604,8 +628,12 @@ void Expand_Mod(bool is_early, ::AST::Crate& crate, LList<const AST::Module*> mo
     DEBUG("Items");
     for( auto& i : mod.items() )
     {
+        if( !is_early && !i.data.late_expand_pending ) {
+            continue ;
+        }
         DEBUG("- " << i.name << " (" << ::AST::Item::tag_to_str(i.data.tag()) << ") :: " << i.data.attrs);
         ::AST::Path path = modpath + i.name;
+        auto late_work_start = g_late_work_count;
         
         auto attrs = mv$(i.data.attrs);
         Expand_Attrs(attrs, stage_pre(is_early),  crate, path, mod, i.data);
@@ -733,6 +761,10 @@ void Expand_Mod(bool is_early, ::AST::Crate& crate, LList<const AST::Module*> mo
         Expand_Attrs(attrs, stage_post(is_early),  crate, path, mod, i.data);
         if( i.data.attrs.m_items.size() == 0 )
             i.data.attrs = mv$(attrs);
+        
+        if( is_early ) {
+            i.data.late_expand_pending = (g_late_work_count != late_work_start);
+        }
     }
     
     // IGNORE m_anon_modules, handled as part of expressions
@@ -740,7 +772,11 @@ void Expand_Mod(bool is_early, ::AST::Crate& crate, LList<const AST::Module*> mo
     DEBUG("Impls");
     for( auto& impl : mod.impls() )
     {
+        if( !is_early && !impl.late_expand_pending ) {
+            continue ;
+        }
         DEBUG("- " << impl);
+        auto late_work_start = g_late_work_count;
         
         Expand_Attrs(impl.def().attrs(), stage_pre(is_early),  crate, mod, impl.def());
         if( impl.def().type().is_wildcard() ) {
@@ -820,6 +856,10 @@ void Expand_Mod(bool is_early, ::AST::Crate& crate, LList<const AST::Module*> mo
         }
 
         Expand_Attrs(impl.def().attrs(), stage_post(is_early),  crate, mod, impl.def());
+        
+        if( is_early ) {
+            impl.late_expand_pending = (g_late_work_count != late_work_start);
+        }
     }
     
     for( auto it = mod.impls().begin(); it != mod.impls().end(); )
@@ -2,11 +2,80 @@
  */
 #include <hir/expr.hpp>
 
+namespace {
+    thread_local const ::std::shared_ptr< ::HIR::ExprNodeTable>* s_current_table = nullptr;
+}
+
+HIR::ExprNodeTable::ExprNodeTable():
+    m_count(0)
+{
+    for(auto& seg : m_segments)
+        seg.store(nullptr, ::std::memory_order_relaxed);
+}
+HIR::ExprNodeTable::~ExprNodeTable()
+{
+    for(auto& seg : m_segments)
+        delete[] seg.load(::std::memory_order_relaxed);
+}
+::HIR::ExprNodeInfo& HIR::ExprNodeTable::allocate()
+{
+    // Segments double in size, so the n-th entry (offset by the first segment's size) is in the segment given by its
+    // highest set bit.
+    unsigned long long pos = static_cast<unsigned long long>(m_count.fetch_add(1, ::std::memory_order_relaxed)) + FIRST_SEGMENT_SIZE;
+    unsigned int seg_idx = 0;
+    while( (pos >> 1) >= (static_cast<unsigned long long>(FIRST_SEGMENT_SIZE) << seg_idx) )
+        seg_idx ++;
+    if( seg_idx >= NUM_SEGMENTS )
+        BUG(Span(), "ExprNodeTable full");
+    pos -= static_cast<unsigned long long>(FIRST_SEGMENT_SIZE) << seg_idx;
+    
+    auto* seg = m_segments[seg_idx].load(::std::memory_order_acquire);
+    if( !seg )
+    {
+        // First entry in this segment (or racing with it), allocate and publish - discarding ours if another thread won
+        auto* new_seg = new ExprNodeInfo[FIRST_SEGMENT_SIZE << seg_idx];
+        if( m_segments[seg_idx].compare_exchange_strong(seg, new_seg, ::std::memory_order_acq_rel, ::std::memory_order_acquire) ) {
+            seg = new_seg;
+        }
+        else {
+            delete[] new_seg;
+        }
+    }
+    return seg[pos];
+}
+::HIR::ExprNodeInfo& HIR::ExprNodeTable::allocate_current()
+{
+    if( !s_current_table || !*s_current_table )
+        BUG(Span(), "Creating a HIR expression node with no active node table");
+    return (*s_current_table)->allocate();
+}
+const ::std::shared_ptr< ::HIR::ExprNodeTable>& HIR::ExprNodeTable::current()
+{
+    static const ::std::shared_ptr<ExprNodeTable> s_null;
+    return s_current_table ? *s_current_table : s_null;
+}
+::HIR::ExprNodeTable::Scope::Scope(::std::shared_ptr<ExprNodeTable> table):
+    m_table( mv$(table) ),
+    m_saved( s_current_table )
+{
+    s_current_table = &m_table;
+}
+::HIR::ExprNodeTable::Scope::~Scope()
+{
+    s_current_table = m_saved;
+}
+
 ::HIR::ExprNode::~ExprNode()
 {
 }
 
-#define DEF_VISIT(nt, n, code)   void ::HIR::nt::visit(ExprVisitor& nv) { nv.visit_node(*this); nv.visit(*this); } void ::HIR::ExprVisitorDef::visit(::HIR::nt& n) { code }
+void ::HIR::ExprNode::visit(ExprVisitor& nv)
+{
+    nv.visit_node(*this);
+    visit_expr_node(*this, nv);
+}
+
+#define DEF_VISIT(nt, n, code)   void ::HIR::ExprVisitorDef::visit(::HIR::nt& n) { code }
 
 void ::HIR::ExprVisitor::visit_node_ptr(::std::unique_ptr< ::HIR::ExprNode>& node_ptr) {
     assert(node_ptr);
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
 #include <hir/pattern.hpp>
 #include <hir/type.hpp>
 #include <span.hpp>
@@ -38,31 +39,119 @@ class GenericParams;
 
 class ExprVisitor;
 
+/// Per-node results filled in by typecheck (and later passes)
+struct ExprNodeInfo
+{
+    ::HIR::TypeRef  res_type;
+    ValueUsage  usage = ValueUsage::Unknown;
+};
+
+/// Side table holding the `ExprNodeInfo` of every node in a body
+///
+/// Kept out of the nodes so the tree stays small (visitors only touch the node headers), with entries allocated in
+/// segments so that their addresses are stable. Closure bodies share the table of the body they were extracted from.
+class ExprNodeTable
+{
+    /// Segment `i` holds `FIRST_SEGMENT_SIZE << i` entries
+    static const unsigned int FIRST_SEGMENT_SIZE = 4;
+    static const unsigned int NUM_SEGMENTS = 30;
+
+    ::std::atomic<unsigned int> m_count;
+    ::std::atomic<ExprNodeInfo*>    m_segments[NUM_SEGMENTS];
+public:
+    ExprNodeTable();
+    ExprNodeTable(const ExprNodeTable&) = delete;
+    ~ExprNodeTable();
+
+    /// Allocate an entry from the table
+    /// - Lock-free, as closure bodies sharing a table can gain nodes on different threads (e.g. in UFCS expansion)
+    ExprNodeInfo& allocate();
+
+    /// Allocate an entry from the current thread's active table (see `Scope`)
+    static ExprNodeInfo& allocate_current();
+    /// Current thread's active table (nullptr if there is no active scope)
+    static const ::std::shared_ptr<ExprNodeTable>& current();
+
+    /// Sets the table that new nodes are allocated from, for the lifetime of the scope
+    class Scope
+    {
+        ::std::shared_ptr<ExprNodeTable>    m_table;
+        const ::std::shared_ptr<ExprNodeTable>* m_saved;
+    public:
+        Scope(::std::shared_ptr<ExprNodeTable> table);
+        Scope(const Scope&) = delete;
+        ~Scope();
+    };
+};
+
+/// Concrete type of an `ExprNode` (used for switch-based dispatch)
+enum class ExprNodeKind : unsigned char
+{
+    Block,
+    Return,
+    Loop,
+    LoopControl,
+    Let,
+    Match,
+    If,
+    Assign,
+    BinOp,
+    UniOp,
+    Borrow,
+    Cast,
+    Unsize,
+    Index,
+    Deref,
+    TupleVariant,
+    CallPath,
+    CallValue,
+    CallMethod,
+    Field,
+    Literal,
+    UnitVariant,
+    PathValue,
+    Variable,
+    StructLiteral,
+    Tuple,
+    ArrayList,
+    ArraySized,
+    Closure,
+};
+
 class ExprNode
 {
 public:
     Span    m_span;
-    ::HIR::TypeRef    m_res_type;
-    ValueUsage  m_usage = ValueUsage::Unknown;
+    /// Concrete node type (a single byte, sits in the padding after the span)
+    ExprNodeKind    m_kind;
+    // - Results stored in the body's `ExprNodeTable`
+    ::HIR::TypeRef& m_res_type;
+    ValueUsage& m_usage;
 
     const Span& span() const { return m_span; }
     
-    virtual void visit(ExprVisitor& v) = 0;
-    ExprNode(Span sp):
-        m_span( mv$(sp) )
+    /// Calls `v.visit_node` and then the `v.visit` overload for this node's type
+    void visit(ExprVisitor& v);
+    ExprNode(ExprNodeKind kind, Span sp):
+        ExprNode( kind, mv$(sp), ExprNodeTable::allocate_current() )
     {}
-    ExprNode(Span sp, ::HIR::TypeRef ty):
+    ExprNode(ExprNodeKind kind, Span sp, ::HIR::TypeRef ty):
+        ExprNode( kind, mv$(sp), ExprNodeTable::allocate_current() )
+    {
+        m_res_type = mv$(ty);
+    }
+    virtual ~ExprNode();
+private:
+    ExprNode(ExprNodeKind kind, Span sp, ExprNodeInfo& info):
         m_span( mv$(sp) ),
-        m_res_type( mv$(ty) )
+        m_kind( kind ),
+        m_res_type( info.res_type ),
+        m_usage( info.usage )
     {}
-    virtual ~ExprNode();
 };
 
 typedef ::std::unique_ptr<ExprNode> ExprNodeP;
 
-#define NODE_METHODS()  \
-    virtual void visit(ExprVisitor& nv) override;
-
 struct ExprNode_Block:
     public ExprNode
 {
@@ -73,16 +162,14 @@ struct ExprNode_Block:
     t_trait_list    m_traits;
     
     ExprNode_Block(Span sp):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::Block, mv$(sp)),
         m_is_unsafe(false)
     {}
     ExprNode_Block(Span sp, bool is_unsafe, ::std::vector<ExprNodeP> nodes):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::Block, mv$(sp) ),
         m_is_unsafe(is_unsafe),
         m_nodes( mv$(nodes) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Return:
     public ExprNode
@@ -90,12 +177,10 @@ struct ExprNode_Return:
     ::HIR::ExprNodeP    m_value;
     
     ExprNode_Return(Span sp, ::HIR::ExprNodeP value):
-        ExprNode(mv$(sp), ::HIR::TypeRef::new_diverge()),
+        ExprNode(ExprNodeKind::Return, mv$(sp), ::HIR::TypeRef::new_diverge()),
         m_value( mv$(value) )
     {
     }
-    
-    NODE_METHODS();
 };
 struct ExprNode_Loop:
     public ExprNode
@@ -104,12 +189,10 @@ struct ExprNode_Loop:
     ::HIR::ExprNodeP    m_code;
     
     ExprNode_Loop(Span sp, ::std::string label, ::HIR::ExprNodeP code):
-        ExprNode(mv$(sp), ::HIR::TypeRef::new_unit()),
+        ExprNode(ExprNodeKind::Loop, mv$(sp), ::HIR::TypeRef::new_unit()),
         m_label( mv$(label) ),
         m_code( mv$(code) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_LoopControl:
     public ExprNode
@@ -119,12 +202,10 @@ struct ExprNode_LoopControl:
     //::HIR::ExprNodeP    m_value;
 
     ExprNode_LoopControl(Span sp, ::std::string label, bool cont):
-        ExprNode(mv$(sp), ::HIR::TypeRef::new_diverge()),
+        ExprNode(ExprNodeKind::LoopControl, mv$(sp), ::HIR::TypeRef::new_diverge()),
         m_label( mv$(label) ),
         m_continue( cont )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Let:
     public ExprNode
@@ -134,13 +215,11 @@ struct ExprNode_Let:
     ::HIR::ExprNodeP    m_value;
     
     ExprNode_Let(Span sp, ::HIR::Pattern pat, ::HIR::TypeRef ty, ::HIR::ExprNodeP val):
-        ExprNode(mv$(sp), ::HIR::TypeRef::new_unit()),
+        ExprNode(ExprNodeKind::Let, mv$(sp), ::HIR::TypeRef::new_unit()),
         m_pattern( mv$(pat) ),
         m_type( mv$(ty) ),
         m_value( mv$(val) )
     {}
-    
-    NODE_METHODS();
 };
 
 struct ExprNode_Match:
@@ -157,12 +236,11 @@ struct ExprNode_Match:
     ::std::vector<Arm> m_arms;
 
     ExprNode_Match(Span sp, ::HIR::ExprNodeP val, ::std::vector<Arm> arms):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::Match, mv$(sp) ),
         m_value( mv$(val) ),
         m_arms( mv$(arms) )
     {}
 
-    NODE_METHODS();
 };
 
 struct ExprNode_If:
@@ -173,13 +251,11 @@ struct ExprNode_If:
     ::HIR::ExprNodeP    m_false;
     
     ExprNode_If(Span sp, ::HIR::ExprNodeP cond, ::HIR::ExprNodeP true_code, ::HIR::ExprNodeP false_code):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::If, mv$(sp) ),
         m_cond( mv$(cond) ),
         m_true( mv$(true_code) ),
         m_false( mv$(false_code) )
     {}
-    
-    NODE_METHODS();
 };
 
 struct ExprNode_Assign:
@@ -217,13 +293,11 @@ struct ExprNode_Assign:
     ExprNodeP   m_value;
 
     ExprNode_Assign(Span sp, Op op, ::HIR::ExprNodeP slot, ::HIR::ExprNodeP value):
-        ExprNode(mv$(sp), ::HIR::TypeRef::new_unit()),
+        ExprNode(ExprNodeKind::Assign, mv$(sp), ::HIR::TypeRef::new_unit()),
         m_op(op),
         m_slot( mv$(slot) ),
         m_value( mv$(value) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_BinOp:
     public ExprNode
@@ -278,7 +352,7 @@ struct ExprNode_BinOp:
     ::HIR::ExprNodeP m_right;
 
     ExprNode_BinOp(Span sp, Op op, ::HIR::ExprNodeP left, ::HIR::ExprNodeP right):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::BinOp, mv$(sp) ),
         m_op(op),
         m_left( mv$(left) ),
         m_right( mv$(right) )
@@ -295,8 +369,6 @@ struct ExprNode_BinOp:
             break;
         }
     }
-    
-    NODE_METHODS();
 };
 struct ExprNode_UniOp:
     public ExprNode
@@ -317,12 +389,10 @@ struct ExprNode_UniOp:
     ::HIR::ExprNodeP    m_value;
 
     ExprNode_UniOp(Span sp, Op op, ::HIR::ExprNodeP value):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::UniOp, mv$(sp) ),
         m_op(op),
         m_value( mv$(value) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Borrow:
     public ExprNode
@@ -331,12 +401,10 @@ struct ExprNode_Borrow:
     ::HIR::ExprNodeP    m_value;
 
     ExprNode_Borrow(Span sp, ::HIR::BorrowType bt, ::HIR::ExprNodeP value):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::Borrow, mv$(sp) ),
         m_type(bt),
         m_value( mv$(value) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Cast:
     public ExprNode
@@ -345,11 +413,9 @@ struct ExprNode_Cast:
     // TODO: Re-instate the local type, to allow for coercions?
 
     ExprNode_Cast(Span sp, ::HIR::ExprNodeP value, ::HIR::TypeRef dst_type):
-        ExprNode( mv$(sp), mv$(dst_type) ),
+        ExprNode(ExprNodeKind::Cast, mv$(sp), mv$(dst_type) ),
         m_value( mv$(value) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Unsize:
     public ExprNode
@@ -357,11 +423,9 @@ struct ExprNode_Unsize:
     ::HIR::ExprNodeP    m_value;
 
     ExprNode_Unsize(Span sp, ::HIR::ExprNodeP value, ::HIR::TypeRef dst_type):
-        ExprNode( mv$(sp), mv$(dst_type) ),
+        ExprNode(ExprNodeKind::Unsize, mv$(sp), mv$(dst_type) ),
         m_value( mv$(value) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Index:
     public ExprNode
@@ -370,12 +434,10 @@ struct ExprNode_Index:
     ::HIR::ExprNodeP    m_index;
     
     ExprNode_Index(Span sp, ::HIR::ExprNodeP val, ::HIR::ExprNodeP index):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::Index, mv$(sp)),
         m_value( mv$(val) ),
         m_index( mv$(index) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Deref:
     public ExprNode
@@ -383,11 +445,9 @@ struct ExprNode_Deref:
     ::HIR::ExprNodeP    m_value;
     
     ExprNode_Deref(Span sp, ::HIR::ExprNodeP val):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::Deref, mv$(sp)),
         m_value( mv$(val) )
     {}
-    
-    NODE_METHODS();
 };
 
 struct ExprNode_TupleVariant:
@@ -402,13 +462,11 @@ struct ExprNode_TupleVariant:
     ::std::vector< ::HIR::TypeRef>  m_arg_types;
     
     ExprNode_TupleVariant(Span sp, ::HIR::GenericPath path, bool is_struct, ::std::vector< ::HIR::ExprNodeP> args):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::TupleVariant, mv$(sp)),
         m_path( mv$(path) ),
         m_is_struct( is_struct ),
         m_args( mv$(args) )
     {}
-    
-    NODE_METHODS();
 };
 
 struct ExprCallCache
@@ -432,12 +490,10 @@ struct ExprNode_CallPath:
     ExprCallCache   m_cache;
     
     ExprNode_CallPath(Span sp, ::HIR::Path path, ::std::vector< ::HIR::ExprNodeP> args):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::CallPath, mv$(sp)),
         m_path( mv$(path) ),
         m_args( mv$(args) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_CallValue:
     public ExprNode
@@ -460,12 +516,10 @@ struct ExprNode_CallValue:
     TraitUsed   m_trait_used = TraitUsed::Unknown;
     
     ExprNode_CallValue(Span sp, ::HIR::ExprNodeP val, ::std::vector< ::HIR::ExprNodeP> args):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::CallValue, mv$(sp)),
         m_value( mv$(val) ),
         m_args( mv$(args) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_CallMethod:
     public ExprNode
@@ -481,7 +535,7 @@ struct ExprNode_CallMethod:
     t_trait_list    m_traits;
 
     ExprNode_CallMethod(Span sp, ::HIR::ExprNodeP val, ::std::string method_name, ::HIR::PathParams params, ::std::vector< ::HIR::ExprNodeP> args):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::CallMethod, mv$(sp) ),
         m_value( mv$(val) ),
         m_method( mv$(method_name) ),
         m_params( mv$(params) ),
@@ -490,8 +544,6 @@ struct ExprNode_CallMethod:
         m_method_path( ::HIR::SimplePath("",{}) )
     {
     }
-    
-    NODE_METHODS();
 };
 struct ExprNode_Field:
     public ExprNode
@@ -500,12 +552,10 @@ struct ExprNode_Field:
     ::std::string   m_field;
     
     ExprNode_Field(Span sp, ::HIR::ExprNodeP val, ::std::string field):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::Field, mv$(sp)),
         m_value( mv$(val) ),
         m_field( mv$(field) )
     {}
-    
-    NODE_METHODS();
 };
 
 struct ExprNode_Literal:
@@ -528,7 +578,7 @@ struct ExprNode_Literal:
     Data m_data;
 
     ExprNode_Literal(Span sp, Data data):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::Literal, mv$(sp) ),
         m_data( mv$(data) )
     {
         TU_MATCH(Data, (m_data), (e),
@@ -569,8 +619,6 @@ struct ExprNode_Literal:
             )
         )
     }
-    
-    NODE_METHODS();
 };
 struct ExprNode_UnitVariant:
     public ExprNode
@@ -580,12 +628,10 @@ struct ExprNode_UnitVariant:
     bool    m_is_struct;
     
     ExprNode_UnitVariant(Span sp, ::HIR::GenericPath path, bool is_struct):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::UnitVariant, mv$(sp)),
         m_path( mv$(path) ),
         m_is_struct( is_struct )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_PathValue:
     public ExprNode
@@ -601,12 +647,10 @@ struct ExprNode_PathValue:
     Target  m_target;
     
     ExprNode_PathValue(Span sp, ::HIR::Path path, Target target):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::PathValue, mv$(sp)),
         m_path( mv$(path) ),
         m_target( target )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_Variable:
     public ExprNode
@@ -615,12 +659,10 @@ struct ExprNode_Variable:
     unsigned int    m_slot;
     
     ExprNode_Variable(Span sp, ::std::string name, unsigned int slot):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::Variable, mv$(sp)),
         m_name( mv$(name) ),
         m_slot( slot )
     {}
-    
-    NODE_METHODS();
 };
 
 struct ExprNode_StructLiteral:
@@ -636,7 +678,7 @@ struct ExprNode_StructLiteral:
     ::std::vector< ::HIR::TypeRef>  m_value_types;
     
     ExprNode_StructLiteral(Span sp, ::HIR::GenericPath path, bool is_struct, ::HIR::ExprNodeP base_value, t_values values):
-        ExprNode( mv$(sp) ),
+        ExprNode(ExprNodeKind::StructLiteral, mv$(sp) ),
         m_path( mv$(path) ),
         m_is_struct( is_struct ),
         m_base_value( mv$(base_value) ),
@@ -645,8 +687,6 @@ struct ExprNode_StructLiteral:
         // TODO: set m_res_type based on path?
         // - Defer, because it requires binding ivars between m_path and m_res_type
     }
-    
-    NODE_METHODS();
 };
 struct ExprNode_Tuple:
     public ExprNode
@@ -654,11 +694,9 @@ struct ExprNode_Tuple:
     ::std::vector< ::HIR::ExprNodeP>    m_vals;
     
     ExprNode_Tuple(Span sp, ::std::vector< ::HIR::ExprNodeP> vals):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::Tuple, mv$(sp)),
         m_vals( mv$(vals) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_ArrayList:
     public ExprNode
@@ -666,11 +704,9 @@ struct ExprNode_ArrayList:
     ::std::vector< ::HIR::ExprNodeP>    m_vals;
     
     ExprNode_ArrayList(Span sp, ::std::vector< ::HIR::ExprNodeP> vals):
-        ExprNode( mv$(sp), ::HIR::TypeRef::new_array( ::HIR::TypeRef(), vals.size() ) ),
+        ExprNode(ExprNodeKind::ArrayList, mv$(sp), ::HIR::TypeRef::new_array( ::HIR::TypeRef(), vals.size() ) ),
         m_vals( mv$(vals) )
     {}
-    
-    NODE_METHODS();
 };
 struct ExprNode_ArraySized:
     public ExprNode
@@ -680,13 +716,11 @@ struct ExprNode_ArraySized:
     size_t  m_size_val;
     
     ExprNode_ArraySized(Span sp, ::HIR::ExprNodeP val, ::HIR::ExprNodeP size):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::ArraySized, mv$(sp)),
         m_val( mv$(val) ),
         m_size( mv$(size) ),
         m_size_val( ~0u )
     {}
-    
-    NODE_METHODS();
 };
 
 struct ExprNode_Closure:
@@ -713,17 +747,13 @@ struct ExprNode_Closure:
     ::HIR::GenericPath  m_obj_path;
     
     ExprNode_Closure(Span sp, args_t args, ::HIR::TypeRef rv, ::HIR::ExprNodeP code):
-        ExprNode(mv$(sp)),
+        ExprNode(ExprNodeKind::Closure, mv$(sp)),
         m_args( ::std::move(args) ),
         m_return( ::std::move(rv) ),
         m_code( ::std::move(code) )
     {}
-    
-    NODE_METHODS();
 };
 
-#undef NODE_METHODS
-
 class ExprVisitor
 {
 public:
@@ -817,5 +847,175 @@ public:
     virtual void visit_generic_path(::HIR::Visitor::PathContext pc, ::HIR::GenericPath& ty);
 };
 
+
+/// Calls `v.visit` with `node` cast to its concrete type
+template<typename V>
+void visit_expr_node(ExprNode& node, V& v)
+{
+    switch(node.m_kind)
+    {
+    #define NV(nt)  case ExprNodeKind::nt: v.visit(static_cast<ExprNode_##nt&>(node)); break;
+    NV(Block)
+    NV(Return)
+    NV(Loop)
+    NV(LoopControl)
+    NV(Let)
+    NV(Match)
+    NV(If)
+    NV(Assign)
+    NV(BinOp)
+    NV(UniOp)
+    NV(Borrow)
+    NV(Cast)
+    NV(Unsize)
+    NV(Index)
+    NV(Deref)
+    NV(TupleVariant)
+    NV(CallPath)
+    NV(CallValue)
+    NV(CallMethod)
+    NV(Field)
+    NV(Literal)
+    NV(UnitVariant)
+    NV(PathValue)
+    NV(Variable)
+    NV(StructLiteral)
+    NV(Tuple)
+    NV(ArrayList)
+    NV(ArraySized)
+    NV(Closure)
+    #undef NV
+    }
 }
 
+/// Statically dispatched expression visitor (CRTP)
+///
+/// `Derived` hides the `visit` overloads (and `visit_node_ptr`) that it handles, everything is resolved at compile
+/// time. The defaults only recurse into child nodes, types and paths within the tree are not visited.
+template<typename Derived>
+class ExprVisitorT
+{
+    Derived& self() { return *static_cast<Derived*>(this); }
+public:
+    void visit_node_ptr(ExprNodeP& node_ptr) {
+        assert(node_ptr);
+        visit_expr_node(*node_ptr, self());
+    }
+
+    void visit(ExprNode_Block& node) {
+        for(auto& subnode : node.m_nodes)
+            self().visit_node_ptr(subnode);
+    }
+    void visit(ExprNode_Return& node) {
+        self().visit_node_ptr(node.m_value);
+    }
+    void visit(ExprNode_Loop& node) {
+        self().visit_node_ptr(node.m_code);
+    }
+    void visit(ExprNode_LoopControl& node) {
+    }
+    void visit(ExprNode_Let& node) {
+        if( node.m_value )
+            self().visit_node_ptr(node.m_value);
+    }
+    void visit(ExprNode_Match& node) {
+        self().visit_node_ptr(node.m_value);
+        for(auto& arm : node.m_arms)
+        {
+            if( arm.m_cond )
+                self().visit_node_ptr(arm.m_cond);
+            self().visit_node_ptr(arm.m_code);
+        }
+    }
+    void visit(ExprNode_If& node) {
+        self().visit_node_ptr(node.m_cond);
+        self().visit_node_ptr(node.m_true);
+        if( node.m_false )
+            self().visit_node_ptr(node.m_false);
+    }
+
+    void visit(ExprNode_Assign& node) {
+        self().visit_node_ptr(node.m_slot);
+        self().visit_node_ptr(node.m_value);
+    }
+    void visit(ExprNode_BinOp& node) {
+        self().visit_node_ptr(node.m_left);
+        self().visit_node_ptr(node.m_right);
+    }
+    void visit(ExprNode_UniOp& node) {
+        self().visit_node_ptr(node.m_value);
+    }
+    void visit(ExprNode_Borrow& node) {
+        self().visit_node_ptr(node.m_value);
+    }
+    void visit(ExprNode_Cast& node) {
+        self().visit_node_ptr(node.m_value);
+    }
+    void visit(ExprNode_Unsize& node) {
+        self().visit_node_ptr(node.m_value);
+    }
+    void visit(ExprNode_Index& node) {
+        self().visit_node_ptr(node.m_value);
+        self().visit_node_ptr(node.m_index);
+    }
+    void visit(ExprNode_Deref& node) {
+        self().visit_node_ptr(node.m_value);
+    }
+
+    void visit(ExprNode_TupleVariant& node) {
+        for(auto& arg : node.m_args)
+            self().visit_node_ptr(arg);
+    }
+    void visit(ExprNode_CallPath& node) {
+        for(auto& arg : node.m_args)
+            self().visit_node_ptr(arg);
+    }
+    void visit(ExprNode_CallValue& node) {
+        self().visit_node_ptr(node.m_value);
+        for(auto& arg : node.m_args)
+            self().visit_node_ptr(arg);
+    }
+    void visit(ExprNode_CallMethod& node) {
+        self().visit_node_ptr(node.m_value);
+        for(auto& arg : node.m_args)
+            self().visit_node_ptr(arg);
+    }
+    void visit(ExprNode_Field& node) {
+        self().visit_node_ptr(node.m_value);
+    }
+
+    void visit(ExprNode_Literal& node) {
+    }
+    void visit(ExprNode_UnitVariant& node) {
+    }
+    void visit(ExprNode_PathValue& node) {
+    }
+    void visit(ExprNode_Variable& node) {
+    }
+
+    void visit(ExprNode_StructLiteral& node) {
+        if( node.m_base_value )
+            self().visit_node_ptr(node.m_base_value);
+        for(auto& val : node.m_values)
+            self().visit_node_ptr(val.second);
+    }
+    void visit(ExprNode_Tuple& node) {
+        for(auto& val : node.m_vals)
+            self().visit_node_ptr(val);
+    }
+    void visit(ExprNode_ArrayList& node) {
+        for(auto& val : node.m_vals)
+            self().visit_node_ptr(val);
+    }
+    void visit(ExprNode_ArraySized& node) {
+        self().visit_node_ptr(node.m_val);
+        self().visit_node_ptr(node.m_size);
+    }
+
+    void visit(ExprNode_Closure& node) {
+        if( node.m_code )
+            self().visit_node_ptr(node.m_code);
+    }
+};
+
+}
@@ -10,6 +10,13 @@
 ::HIR::ExprPtr::ExprPtr(::std::unique_ptr< ::HIR::ExprNode> v):
     node( v.release() )
 {
+    if( node )
+    {
+        // The nodes were allocated from the active table, keep it alive for as long as they are
+        m_node_table = ::HIR::ExprNodeTable::current();
+        if( !m_node_table )
+            BUG(node->span(), "Creating a HIR expression with no active node table");
+    }
 }
 ::HIR::ExprPtr::~ExprPtr()
 {
@@ -15,9 +15,12 @@ namespace HIR {
 
 class TypeRef;
 class ExprNode;
+class ExprNodeTable;
 
 class ExprPtr
 {
+    // Owns the per-node results referenced by the nodes (see ExprNodeTable)
+    ::std::shared_ptr< ::HIR::ExprNodeTable>    m_node_table;
     ::HIR::ExprNode* node;
     
 public:
@@ -28,6 +31,7 @@ public:
     ExprPtr();
     ExprPtr(::std::unique_ptr< ::HIR::ExprNode> _);
     ExprPtr(ExprPtr&& x):
+        m_node_table( ::std::move(x.m_node_table) ),
         node(x.node),
         m_bindings( ::std::move(x.m_bindings) ),
         m_mir( ::std::move(x.m_mir) )
@@ -36,7 +40,9 @@ public:
     }
     ExprPtr& operator=(ExprPtr&& x)
     {
-        this->~ExprPtr();
+        // NOTE: Nodes are released before the table their results live in
+        this->reset(nullptr);
+        m_node_table = ::std::move(x.m_node_table);
         node = x.node;
         m_bindings = ::std::move(x.m_bindings);
         m_mir = ::std::move(x.m_mir);
@@ -49,6 +55,9 @@ public:
     operator bool () const { return node != nullptr; }
     ::HIR::ExprNode* get() const { return node; }
     void reset(::HIR::ExprNode* p);
+
+    /// Table holding the result types of this body's nodes (new nodes should be created within a scope for it)
+    const ::std::shared_ptr< ::HIR::ExprNodeTable>& node_table() const { return m_node_table; }
     
           ::HIR::ExprNode& operator*()       { return *node; }
     const ::HIR::ExprNode& operator*() const { return *node; }
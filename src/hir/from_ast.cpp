@@ -761,6 +761,7 @@ namespace {
         mv$(lifetime),
         mv$(supertraits)
         };
+    rv.m_is_marker = f.is_marker();
 
     {
         auto this_trait = ::HIR::GenericPath( trait_path );
@@ -867,14 +868,18 @@ void _add_mod_val_item(::HIR::Module& mod, ::std::string name, bool is_pub,  ::H
     mod.m_traits = mv$(traits);
     
     // Populate trait list
-    for(const auto& item : ast_mod.m_type_items)
-    {
-        if( item.second.path.binding().is_Trait() ) {
-            auto sp = LowerHIR_SimplePath(Span(), item.second.path);
+    auto add_trait = [&](const ::std::string& , const ::AST::Module::IndexEnt& ent) {
+        if( ent.path.binding().is_Trait() ) {
+            auto sp = LowerHIR_SimplePath(Span(), ent.path);
             if( ::std::find(mod.m_traits.begin(), mod.m_traits.end(), sp) == mod.m_traits.end() )
                 mod.m_traits.push_back( mv$(sp) ); 
         }
+        };
+    for(const auto& item : ast_mod.m_type_items)
+    {
+        add_trait(item.first, item.second);
     }
+    ast_mod.visit_glob_type_items(add_trait);
     
     for( unsigned int i = 0; i < ast_mod.anon_mods().size(); i ++ )
     {
@@ -1093,7 +1098,7 @@ public:
 ///
 /// - Removes all possibility for unexpanded macros
 /// - Performs desugaring of for/if-let/while-let/...
-::HIR::CratePtr LowerHIR_FromAST(::AST::Crate crate)
+::HIR::CratePtr LowerHIR_FromAST(::AST::Crate& crate)
 {
     ::HIR::Crate    rv;
     auto& macros = rv.m_exported_macros;
@@ -1122,6 +1127,8 @@ public:
         rv.m_lang_items.insert( ::std::make_pair(lang_item_path.first, LowerHIR_SimplePath(sp, lang_item_path.second)) );
     }
     
+    rv.build_path_index();
+    
     // Set all pointers in the HIR to the correct (now fixed) locations
     IndexVisitor(rv).visit_crate( rv );
     
@@ -621,5 +621,6 @@ struct LowerHIR_ExprNode_Visitor:
 
 ::HIR::ExprPtr LowerHIR_ExprNode(const ::AST::ExprNode& e)
 {
+    ::HIR::ExprNodeTable::Scope node_table { ::std::make_shared< ::HIR::ExprNodeTable>() };
     return ::HIR::ExprPtr( LowerHIR_ExprNode_Inner(e) );
 }
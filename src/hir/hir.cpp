@@ -15,6 +15,15 @@ namespace HIR {
                 os << " " << val << ",";
             os << " ]";
             ),
+        (Repeat,
+            os << "[ " << *e.value << "; " << e.count << " ]";
+            ),
+        (Bytes,
+            os << "b[";
+            for(auto b : e)
+                os << " " << static_cast<unsigned int>(b) << ",";
+            os << " ]";
+            ),
         (Integer,
             os << e;
             ),
@@ -353,6 +362,44 @@ const ::HIR::SimplePath& ::HIR::Crate::get_lang_item_path(const Span& sp, const
     return it->second;
 }
 
+size_t ::HIR::Crate::PathHash::operator()(const ::HIR::SimplePath& p) const
+{
+    ::std::hash< ::std::string>    h;
+    size_t  rv = h(p.m_crate_name);
+    for(const auto& c : p.m_components)
+        rv = rv * 31 + h(c);
+    return rv;
+}
+namespace {
+    void build_path_index_mod(::HIR::Crate& crate, const ::HIR::SimplePath& path, const ::HIR::Module& mod)
+    {
+        for(const auto& ent : mod.m_mod_items)
+        {
+            auto ipath = path + ent.first;
+            TU_IFLET(::HIR::TypeItem, ent.second->ent, Module, e,
+                build_path_index_mod(crate, ipath, e);
+            )
+            crate.m_type_index.insert( ::std::make_pair( mv$(ipath), &ent.second->ent ) );
+        }
+        for(const auto& ent : mod.m_value_items)
+        {
+            crate.m_value_index.insert( ::std::make_pair( path + ent.first, &ent.second->ent ) );
+        }
+    }
+}
+void ::HIR::Crate::build_path_index()
+{
+    m_type_index.clear();
+    m_value_index.clear();
+    build_path_index_mod(*this, ::HIR::SimplePath(), m_root_module);
+    DEBUG(m_type_index.size() << " types, " << m_value_index.size() << " values");
+}
+void ::HIR::Crate::add_to_path_index(::HIR::SimplePath path, const ::HIR::TypeItem& item)
+{
+    assert( !item.is_Module() );
+    m_type_index.insert( ::std::make_pair( mv$(path), &item ) );
+}
+
 const ::HIR::TypeItem& ::HIR::Crate::get_typeitem_by_path(const Span& sp, const ::HIR::SimplePath& path) const
 {
     if( path.m_components.size() == 0) {
@@ -361,6 +408,10 @@ const ::HIR::TypeItem& ::HIR::Crate::get_typeitem_by_path(const Span& sp, const
     if( path.m_crate_name != "" )
         TODO(sp, "::HIR::Crate::get_typeitem_by_path in extern crate");
     
+    auto idx_it = m_type_index.find(path);
+    if( idx_it != m_type_index.end() )
+        return *idx_it->second;
+    // Not indexed (index not yet built, or the path is invalid), walk the module tree
     const ::HIR::Module* mod = &this->m_root_module;
     for( unsigned int i = 0; i < path.m_components.size() - 1; i ++ )
     {
@@ -433,6 +484,10 @@ const ::HIR::ValueItem& ::HIR::Crate::get_valitem_by_path(const Span& sp, const
     if( path.m_crate_name != "" )
         TODO(sp, "::HIR::Crate::get_valitem_by_path in extern crate");
     
+    auto idx_it = m_value_index.find(path);
+    if( idx_it != m_value_index.end() )
+        return *idx_it->second;
+    // Not indexed (index not yet built, or the path is invalid), walk the module tree
     const ::HIR::Module* mod = &this->m_root_module;
     for( unsigned int i = 0; i < path.m_components.size() - 1; i ++ )
     {
@@ -466,7 +521,7 @@ const ::HIR::Function& ::HIR::Crate::get_function_by_path(const Span& sp, const
     }
 }
 
-bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TraitImpl&)> callback) const
+bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, FunctionRef<bool(const ::HIR::TraitImpl&)> callback) const
 {
     auto its = this->m_trait_impls.equal_range( trait );
     for( auto it = its.first; it != its.second; ++ it )
@@ -480,7 +535,7 @@ bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR:
     }
     return false;
 }
-bool ::HIR::Crate::find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback) const
+bool ::HIR::Crate::find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, FunctionRef<bool(const ::HIR::TypeImpl&)> callback) const
 {
     for( const auto& impl : this->m_type_impls )
     {
@@ -43,7 +43,14 @@ struct VisEnt
 TAGGED_UNION(Literal, Invalid,
     (Invalid, struct {}),
     // List = Array, Tuple, struct literal
-    (List, ::std::vector<Literal>), // TODO: Have a variant for repetition lists
+    (List, ::std::vector<Literal>),
+    // Repeat = `[val; count]` array, the value is stored once
+    (Repeat, struct {
+        ::std::unique_ptr<Literal>  value;
+        uint64_t    count;
+        }),
+    // Bytes = Array of integers that all fit in a byte, packed one per element
+    (Bytes, ::std::vector<uint8_t>),
     (Integer, uint64_t),
     (Float, double),
     // String = &'static str or &[u8; N]
@@ -167,7 +174,8 @@ struct Trait
     Trait( GenericParams gps, ::std::string lifetime, ::std::vector< ::HIR::TraitPath> parents):
         m_params( mv$(gps) ),
         m_lifetime( mv$(lifetime) ),
-        m_parent_traits( mv$(parents) )
+        m_parent_traits( mv$(parents) ),
+        m_is_marker(false)
     {}
 };
 
@@ -293,6 +301,17 @@ public:
     /// Language items avaliable through this crate (includes ones from loaded externs)
     ::std::unordered_map< ::std::string, ::HIR::SimplePath> m_lang_items;
     
+    struct PathHash {
+        size_t operator()(const ::HIR::SimplePath& p) const;
+    };
+    /// Index of all items in the crate by full path (so `get_*_by_path` doesn't need to walk the module tree)
+    /// - Built by `build_path_index` after lowering, items added after that must be added using `add_to_path_index`
+    ::std::unordered_map< ::HIR::SimplePath, const ::HIR::TypeItem*, PathHash>  m_type_index;
+    ::std::unordered_map< ::HIR::SimplePath, const ::HIR::ValueItem*, PathHash> m_value_index;
+    
+    void build_path_index();
+    void add_to_path_index(::HIR::SimplePath path, const ::HIR::TypeItem& item);
+    
     const ::HIR::SimplePath& get_lang_item_path(const Span& sp, const char* name) const;
     
     const ::HIR::TypeItem& get_typeitem_by_path(const Span& sp, const ::HIR::SimplePath& path) const;
@@ -322,8 +341,8 @@ public:
         }
     }
     
-    bool find_trait_impls(const ::HIR::SimplePath& path, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TraitImpl&)> callback) const;
-    bool find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback) const;
+    bool find_trait_impls(const ::HIR::SimplePath& path, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, FunctionRef<bool(const ::HIR::TraitImpl&)> callback) const;
+    bool find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, FunctionRef<bool(const ::HIR::TypeImpl&)> callback) const;
 };
 
 class ItemPath
@@ -331,31 +350,35 @@ class ItemPath
     const ItemPath* parent;
     const ::HIR::TypeRef* ty;
     const ::HIR::SimplePath* trait;
+    const ::HIR::PathParams* trait_args;
     const char* name;
     
 public:
-    ItemPath(): parent(nullptr), ty(nullptr), trait(nullptr), name(nullptr) {}
+    ItemPath(): parent(nullptr), ty(nullptr), trait(nullptr), trait_args(nullptr), name(nullptr) {}
     ItemPath(const ItemPath& p, const char* n):
         parent(&p),
-        ty(nullptr), trait(nullptr),
+        ty(nullptr), trait(nullptr), trait_args(nullptr),
         name(n)
     {}
     ItemPath(const ::HIR::TypeRef& type):
         parent(nullptr),
         ty(&type),
         trait(nullptr),
+        trait_args(nullptr),
         name(nullptr)
     {}
-    ItemPath(const ::HIR::TypeRef& type, const ::HIR::SimplePath& path):
+    ItemPath(const ::HIR::TypeRef& type, const ::HIR::SimplePath& path, const ::HIR::PathParams* args=nullptr):
         parent(nullptr),
         ty(&type),
         trait(&path),
+        trait_args(args),
         name(nullptr)
     {}
     ItemPath(const ::HIR::SimplePath& path):
         parent(nullptr),
         ty(nullptr),
         trait(&path),
+        trait_args(nullptr),
         name(nullptr)
     {}
     
@@ -385,6 +408,8 @@ public:
             os << "<" << *x.ty;
             if( x.trait )
                 os << " as " << *x.trait;
+            if( x.trait_args )
+                os << *x.trait_args;
             os << ">";
         }
         else if( x.trait ) {
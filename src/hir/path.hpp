@@ -8,12 +8,13 @@
 #include <tagged_union.hpp>
 #include <hir/type_ptr.hpp>
 #include <span.hpp>
+#include <function_ref.hpp>
 
 namespace HIR {
 
 struct Trait;
 
-typedef ::std::function<const ::HIR::TypeRef&(const ::HIR::TypeRef&)> t_cb_resolve_type;
+typedef FunctionRef<const ::HIR::TypeRef&(const ::HIR::TypeRef&)> t_cb_resolve_type;
 enum Compare {
     Equal,
     Fuzzy,
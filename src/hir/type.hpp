@@ -16,7 +16,7 @@ struct ExprNode_Closure;
 
 class TypeRef;
 
-typedef ::std::function< ::HIR::Compare(unsigned int, const ::HIR::TypeRef&) > t_cb_match_generics;
+typedef FunctionRef< ::HIR::Compare(unsigned int, const ::HIR::TypeRef&) > t_cb_match_generics;
 
 enum class InferClass
 {
@@ -100,7 +100,8 @@ void ::HIR::Visitor::visit_type_impl(::HIR::TypeImpl& impl)
 }
 void ::HIR::Visitor::visit_trait_impl(const ::HIR::SimplePath& trait_path, ::HIR::TraitImpl& impl)
 {
-    ::HIR::ItemPath    p( impl.m_type, trait_path );
+    // NOTE: Includes the trait's parameters, as the path must distinguish e.g. `impl G<u8> for T` from `impl G<u16> for T`
+    ::HIR::ItemPath    p( impl.m_type, trait_path, &impl.m_trait_args );
     TRACE_FUNCTION_F(p);
     this->visit_params(impl.m_params);
     // - HACK: Create a generic path to visit (so that proper checks are performed)
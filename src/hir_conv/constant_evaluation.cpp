@@ -23,6 +23,12 @@ namespace {
             }
             return ::HIR::Literal( mv$(vals) );
             ),
+        (Repeat,
+            return ::HIR::Literal::make_Repeat({ box$( clone_literal(*e.value) ), e.count });
+            ),
+        (Bytes,
+            return ::HIR::Literal(e);
+            ),
         (Integer,
             return ::HIR::Literal(e);
             ),
@@ -172,18 +178,63 @@ namespace {
         return *rv_p;
     }
     
-    ::HIR::Literal evaluate_constant(const ::HIR::Crate& crate, const ::HIR::ExprNode& expr)
+    /// Constant being evaluated (used to detect cycles)
+    struct ConstStackEnt {
+        const ::HIR::Constant*  constant;
+        // - One of these is set, depending on if the evaluation was from a use or from the definition
+        const ::HIR::Path*  path;
+        const ::HIR::ItemPath*  item_path;
+    };
+    typedef ::std::vector<ConstStackEnt>    t_const_stack;
+    
+    ::std::ostream& operator<<(::std::ostream& os, const ConstStackEnt& e) {
+        if( e.path )
+            os << *e.path;
+        else
+            os << *e.item_path;
+        return os;
+    }
+    
+    ::HIR::Literal evaluate_constant(const ::HIR::Crate& crate, t_const_stack& const_stack, const ::HIR::ExprNode& expr);
+    
+    /// Obtain the value of a constant, evaluating (and saving) it on first use
+    /// - Dependencies are thus evaluated (once) before the constants that use them
+    const ::HIR::Literal& get_constant_value(const Span& sp, const ::HIR::Crate& crate, t_const_stack& const_stack, ConstStackEnt ent)
+    {
+        const auto& c = *ent.constant;
+        if( c.m_value_res.is_Invalid() )
+        {
+            auto it = ::std::find_if(const_stack.begin(), const_stack.end(), [&](const auto& x){ return x.constant == &c; });
+            if( it != const_stack.end() ) {
+                ERROR(sp, E0000, "Cycle in constant evaluation - " << FMT_CB(os,
+                    for(; it != const_stack.end(); ++it)
+                        os << *it << " -> ";
+                    os << ent;
+                    ));
+            }
+            
+            const_stack.push_back( ent );
+            auto val = evaluate_constant(crate, const_stack, *c.m_value);
+            const_stack.pop_back();
+            const_cast< ::HIR::Constant&>(c).m_value_res = mv$(val);
+        }
+        return c.m_value_res;
+    }
+    
+    ::HIR::Literal evaluate_constant(const ::HIR::Crate& crate, t_const_stack& const_stack, const ::HIR::ExprNode& expr)
     {
         struct Visitor:
             public ::HIR::ExprVisitor
         {
             const ::HIR::Crate& m_crate;
+            t_const_stack&  m_const_stack;
             ::std::vector< ::std::pair< ::std::string, ::HIR::Literal > >   m_values;
             
             ::HIR::Literal  m_rv;
             
-            Visitor(const ::HIR::Crate& crate):
-                m_crate(crate)
+            Visitor(const ::HIR::Crate& crate, t_const_stack& const_stack):
+                m_crate(crate),
+                m_const_stack(const_stack)
             {}
             
             void badnode(const ::HIR::ExprNode& node) const {
@@ -435,12 +486,7 @@ namespace {
             void visit(::HIR::ExprNode_PathValue& node) override {
                 TRACE_FUNCTION_FR("_PathValue - " << node.m_path, m_rv);
                 const auto& c = get_constant(node.span(), m_crate, node.m_path);
-                if( c.m_value_res.is_Invalid() ) {
-                    const_cast<HIR::ExprNode&>(*c.m_value).visit(*this);
-                }
-                else {
-                    m_rv = clone_literal(c.m_value_res);
-                }
+                m_rv = clone_literal( get_constant_value(node.span(), m_crate, m_const_stack, ConstStackEnt { &c, &node.m_path, nullptr }) );
             }
             void visit(::HIR::ExprNode_Variable& node) override {
                 TRACE_FUNCTION_FR("_Variable - " << node.m_name, m_rv);
@@ -508,16 +554,42 @@ namespace {
                 m_rv = ::HIR::Literal::make_List(mv$(vals));
             }
             void visit(::HIR::ExprNode_ArrayList& node) override {
+                TRACE_FUNCTION_FR("_ArrayList", m_rv);
+                // Arrays of byte-sized integers are packed, and only expanded to a list if a larger value appears
+                ::std::vector<uint8_t>  bytes;
                 ::std::vector< ::HIR::Literal>  vals;
+                bool is_bytes = true;
                 for(const auto& vn : node.m_vals ) {
                     vn->visit(*this);
                     assert( !m_rv.is_Invalid() );
+                    if( is_bytes && m_rv.is_Integer() && m_rv.as_Integer() <= 0xFF ) {
+                        bytes.push_back( static_cast<uint8_t>(m_rv.as_Integer()) );
+                        continue ;
+                    }
+                    if( is_bytes ) {
+                        vals.reserve( node.m_vals.size() );
+                        for(auto b : bytes)
+                            vals.push_back( ::HIR::Literal( static_cast<uint64_t>(b) ) );
+                        bytes.clear();
+                        is_bytes = false;
+                    }
                     vals.push_back( mv$(m_rv) );
                 }
-                m_rv = ::HIR::Literal::make_List(mv$(vals));
+                if( is_bytes && !bytes.empty() )
+                    m_rv = ::HIR::Literal::make_Bytes(mv$(bytes));
+                else
+                    m_rv = ::HIR::Literal::make_List(mv$(vals));
             }
             void visit(::HIR::ExprNode_ArraySized& node) override {
-                TODO(node.span(), "ExprNode_ArraySized");
+                TRACE_FUNCTION_FR("_ArraySized", m_rv);
+                node.m_size->visit(*this);
+                auto size = mv$(m_rv);
+                if( !size.is_Integer() )
+                    ERROR(node.span(), E0000, "Array size isn't an integer");
+                node.m_val->visit(*this);
+                assert( !m_rv.is_Invalid() );
+                auto val = mv$(m_rv);
+                m_rv = ::HIR::Literal::make_Repeat({ box$(val), size.as_Integer() });
             }
             
             void visit(::HIR::ExprNode_Closure& node) override {
@@ -525,7 +597,7 @@ namespace {
             }
         };
         
-        Visitor v { crate };
+        Visitor v { crate, const_stack };
         const_cast<::HIR::ExprNode&>(expr).visit(v);
         
         if( v.m_rv.is_Invalid() ) {
@@ -539,6 +611,7 @@ namespace {
         public ::HIR::Visitor
     {
         const ::HIR::Crate& m_crate;
+        t_const_stack   m_const_stack;
 
     public:
         Expander(const ::HIR::Crate& crate):
@@ -548,9 +621,9 @@ namespace {
         void visit_type(::HIR::TypeRef& ty) override
         {
             TU_IFLET(::HIR::TypeRef::Data, ty.m_data, Array, e,
-                ::HIR::Visitor::visit_type(*e.inner);
+                visit_type(*e.inner);
                 assert(e.size.get() != nullptr);
-                auto val = evaluate_constant(m_crate, *e.size);
+                auto val = evaluate_constant(m_crate, m_const_stack, *e.size);
                 if( !val.is_Integer() )
                     ERROR(e.size->span(), E0000, "Array size isn't an integer");
                 e.size_val = val.as_Integer();
@@ -563,14 +636,17 @@ namespace {
         void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override
         {
             visit_type(item.m_type);
-            item.m_value_res = evaluate_constant(m_crate, *item.m_value);
+            // NOTE: Will already have a value if an earlier item used this constant
+            get_constant_value(item.m_value->span(), m_crate, m_const_stack, ConstStackEnt { &item, nullptr, &p });
             DEBUG("constant: " << item.m_type <<  " = " << item.m_value_res);
+            visit_expr(item.m_value);
         }
         void visit_static(::HIR::ItemPath p, ::HIR::Static& item) override
         {
             visit_type(item.m_type);
-            item.m_value_res = evaluate_constant(m_crate, *item.m_value);
+            item.m_value_res = evaluate_constant(m_crate, m_const_stack, *item.m_value);
             DEBUG("static: " << item.m_type <<  " = " << item.m_value_res);
+            visit_expr(item.m_value);
         }
         void visit_expr(::HIR::ExprPtr& expr) override
         {
@@ -604,7 +680,7 @@ namespace {
                 }
 
                 void visit(::HIR::ExprNode_ArraySized& node) override {
-                    auto val = evaluate_constant(m_exp.m_crate, *node.m_size);
+                    auto val = evaluate_constant(m_exp.m_crate, m_exp.m_const_stack, *node.m_size);
                     if( !val.is_Integer() )
                         ERROR(node.span(), E0000, "Array size isn't an integer");
                     node.m_size_val = val.as_Integer();
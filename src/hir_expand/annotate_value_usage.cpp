@@ -9,12 +9,13 @@
 #include <hir/expr.hpp>
 #include <hir_typeck/static.hpp>
 #include <algorithm>
+#include <thread_pool.hpp>
 #include "main_bindings.hpp"
 
 namespace {
     
     class ExprVisitor_Mark:
-        public ::HIR::ExprVisitor//Def
+        public ::HIR::ExprVisitorT<ExprVisitor_Mark>
     {
         const StaticTraitResolve&    m_resolve;
         ::std::vector< ::HIR::ValueUsage>   m_usage;
@@ -59,10 +60,10 @@ namespace {
             assert(root_ptr);
             root_ptr->m_usage = this->get_usage();
             auto expected_size = m_usage.size();
-            root_ptr->visit( *this );
+            ::HIR::visit_expr_node(*root_ptr, *this);
             assert( m_usage.size() == expected_size );
         }
-        void visit_node_ptr(::HIR::ExprNodeP& node_ptr) override
+        void visit_node_ptr(::HIR::ExprNodeP& node_ptr)
         {
             assert(node_ptr);
             
@@ -73,11 +74,11 @@ namespace {
             node_ptr->m_usage = this->get_usage();
             
             auto expected_size = m_usage.size();
-            node_ptr->visit( *this );
+            ::HIR::visit_expr_node(*node_ptr, *this);
             assert( m_usage.size() == expected_size );
         }
         
-        void visit(::HIR::ExprNode_Block& node) override
+        void visit(::HIR::ExprNode_Block& node)
         {
             auto _ = this->push_usage( ::HIR::ValueUsage::Move );
             
@@ -86,12 +87,12 @@ namespace {
             }
         }
         
-        void visit(::HIR::ExprNode_Return& node) override
+        void visit(::HIR::ExprNode_Return& node)
         {
             auto _ = this->push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr( node.m_value );
         }
-        void visit(::HIR::ExprNode_Let& node) override
+        void visit(::HIR::ExprNode_Let& node)
         {
             if( node.m_value )
             {
@@ -99,16 +100,16 @@ namespace {
                 this->visit_node_ptr( node.m_value );
             }
         }
-        void visit(::HIR::ExprNode_Loop& node) override
+        void visit(::HIR::ExprNode_Loop& node)
         {
             auto _ = this->push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr( node.m_code );
         }
-        void visit(::HIR::ExprNode_LoopControl& node) override
+        void visit(::HIR::ExprNode_LoopControl& node)
         {
             // NOTE: Leaf
         }
-        void visit(::HIR::ExprNode_Match& node) override
+        void visit(::HIR::ExprNode_Match& node)
         {
             {
                 const auto& val_ty = node.m_value->m_res_type;
@@ -131,7 +132,7 @@ namespace {
                 this->visit_node_ptr( arm.m_code );
             }
         }
-        void visit(::HIR::ExprNode_If& node) override
+        void visit(::HIR::ExprNode_If& node)
         {
             auto _ = this->push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr( node.m_cond );
@@ -141,7 +142,7 @@ namespace {
             }
         }
         
-        void visit(::HIR::ExprNode_Assign& node) override
+        void visit(::HIR::ExprNode_Assign& node)
         {
             {
                 auto _ = this->push_usage( ::HIR::ValueUsage::Mutate );
@@ -152,7 +153,7 @@ namespace {
                 this->visit_node_ptr(node.m_value);
             }
         }
-        void visit(::HIR::ExprNode_UniOp& node) override
+        void visit(::HIR::ExprNode_UniOp& node)
         {
             m_usage.push_back( ::HIR::ValueUsage::Move );
             
@@ -160,7 +161,7 @@ namespace {
             
             m_usage.pop_back();
         }
-        void visit(::HIR::ExprNode_Borrow& node) override
+        void visit(::HIR::ExprNode_Borrow& node)
         {
             switch(node.m_type)
             {
@@ -180,7 +181,7 @@ namespace {
             m_usage.pop_back();
         }
         
-        void visit(::HIR::ExprNode_BinOp& node) override
+        void visit(::HIR::ExprNode_BinOp& node)
         {
             switch(node.m_op)
             {
@@ -202,17 +203,17 @@ namespace {
             
             m_usage.pop_back();
         }
-        void visit(::HIR::ExprNode_Cast& node) override
+        void visit(::HIR::ExprNode_Cast& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Unsize& node) override
+        void visit(::HIR::ExprNode_Unsize& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Index& node) override
+        void visit(::HIR::ExprNode_Index& node)
         {
             // TODO: Override to ::Borrow if Res: Copy and moving
             if( this->get_usage() == ::HIR::ValueUsage::Move && type_is_copy(node.m_res_type) ) {
@@ -226,7 +227,7 @@ namespace {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr(node.m_index);
         }
-        void visit(::HIR::ExprNode_Deref& node) override
+        void visit(::HIR::ExprNode_Deref& node)
         {
             if( this->get_usage() == ::HIR::ValueUsage::Move && type_is_copy(node.m_res_type) ) {
                 auto _ = push_usage( ::HIR::ValueUsage::Borrow );
@@ -237,7 +238,7 @@ namespace {
             }
         }
         
-        void visit(::HIR::ExprNode_Field& node) override
+        void visit(::HIR::ExprNode_Field& node)
         {
             // If taking this field by value, but the type is Copy - pretend it's a borrow.
             if( this->get_usage() == ::HIR::ValueUsage::Move && type_is_copy(node.m_res_type) ) {
@@ -249,21 +250,21 @@ namespace {
             }
         }
         
-        void visit(::HIR::ExprNode_TupleVariant& node) override
+        void visit(::HIR::ExprNode_TupleVariant& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             
             for( auto& val : node.m_args )
                 this->visit_node_ptr(val);
         }
-        void visit(::HIR::ExprNode_CallPath& node) override
+        void visit(::HIR::ExprNode_CallPath& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             
             for( auto& val : node.m_args )
                 this->visit_node_ptr(val);
         }
-        void visit(::HIR::ExprNode_CallValue& node) override
+        void visit(::HIR::ExprNode_CallValue& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             
@@ -271,7 +272,7 @@ namespace {
             for( auto& val : node.m_args )
                 this->visit_node_ptr(val);
         }
-        void visit(::HIR::ExprNode_CallMethod& node) override
+        void visit(::HIR::ExprNode_CallMethod& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             
@@ -280,20 +281,20 @@ namespace {
                 this->visit_node_ptr(val);
         }
         
-        void visit(::HIR::ExprNode_Literal& node) override
+        void visit(::HIR::ExprNode_Literal& node)
         {
         }
-        void visit(::HIR::ExprNode_UnitVariant& node) override
+        void visit(::HIR::ExprNode_UnitVariant& node)
         {
         }
-        void visit(::HIR::ExprNode_PathValue& node) override
+        void visit(::HIR::ExprNode_PathValue& node)
         {
         }
-        void visit(::HIR::ExprNode_Variable& node) override
+        void visit(::HIR::ExprNode_Variable& node)
         {
         }
 
-        void visit(::HIR::ExprNode_StructLiteral& node) override
+        void visit(::HIR::ExprNode_StructLiteral& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             
@@ -304,27 +305,27 @@ namespace {
                 this->visit_node_ptr(fld_val.second);
             }
         }
-        void visit(::HIR::ExprNode_Tuple& node) override
+        void visit(::HIR::ExprNode_Tuple& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             for( auto& val : node.m_vals ) {
                 this->visit_node_ptr(val);
             }
         }
-        void visit(::HIR::ExprNode_ArrayList& node) override
+        void visit(::HIR::ExprNode_ArrayList& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             for( auto& val : node.m_vals ) {
                 this->visit_node_ptr(val);
             }
         }
-        void visit(::HIR::ExprNode_ArraySized& node) override
+        void visit(::HIR::ExprNode_ArraySized& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr(node.m_val);
         }
         
-        void visit(::HIR::ExprNode_Closure& node) override
+        void visit(::HIR::ExprNode_Closure& node)
         {
             auto _ = push_usage( ::HIR::ValueUsage::Move );
             this->visit_node_ptr(node.m_code);
@@ -347,17 +348,41 @@ namespace {
     class OuterVisitor:
         public ::HIR::Visitor
     {
-        StaticTraitResolve   m_resolve;
+        /// Expression bodies to annotate, along with the generic scope they're within
+        struct Body {
+            ::HIR::ExprPtr* exp;
+            ::HIR::GenericParams*   impl_generics;
+            ::HIR::GenericParams*   item_generics;
+        };
+        
+        const ::HIR::Crate& m_crate;
+        ::HIR::GenericParams*   m_impl_generics;
+        ::HIR::GenericParams*   m_item_generics;
+        ::std::vector<Body> m_bodies;
+        TypeEqualityCache   m_equality_cache;
     public:
         OuterVisitor(const ::HIR::Crate& crate):
-            m_resolve(crate)
+            m_crate(crate),
+            m_impl_generics(nullptr),
+            m_item_generics(nullptr)
         {}
         
+        void visit_crate(::HIR::Crate& crate) override
+        {
+            ::HIR::Visitor::visit_crate(crate);
+            
+            // Bodies are independent of each other, so they can be annotated in parallel
+            parallel_for(m_bodies.size(), [&](unsigned int i) {
+                const auto& body = m_bodies[i];
+                HIR_Expand_AnnotateUsage_Expr(m_crate, body.impl_generics, body.item_generics, *body.exp, &m_equality_cache);
+                });
+            m_bodies.clear();
+        }
+        
         void visit_expr(::HIR::ExprPtr& exp) override {
             if( exp )
             {
-                ExprVisitor_Mark    ev { m_resolve };
-                ev.visit_root( exp );
+                m_bodies.push_back( Body { &exp, m_impl_generics, m_item_generics } );
             }
         }
         
@@ -365,9 +390,11 @@ namespace {
         // Code-containing items
         // ------
         void visit_function(::HIR::ItemPath p, ::HIR::Function& item) override {
-            auto _ = this->m_resolve.set_item_generics(item.m_params);
+            assert( !m_item_generics );
+            m_item_generics = &item.m_params;
             DEBUG("Function " << p);
             ::HIR::Visitor::visit_function(p, item);
+            m_item_generics = nullptr;
         }
         void visit_static(::HIR::ItemPath p, ::HIR::Static& item) override {
             // NOTE: No generics
@@ -378,33 +405,45 @@ namespace {
             ::HIR::Visitor::visit_constant(p, item);
         }
         void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
-            auto _ = this->m_resolve.set_item_generics(item.m_params);
+            assert( !m_item_generics );
+            m_item_generics = &item.m_params;
             ::HIR::Visitor::visit_enum(p, item);
+            m_item_generics = nullptr;
         }
         
         
         void visit_trait(::HIR::ItemPath p, ::HIR::Trait& item) override {
-            auto _ = this->m_resolve.set_impl_generics(item.m_params);
+            assert( !m_impl_generics );
+            m_impl_generics = &item.m_params;
             ::HIR::Visitor::visit_trait(p, item);
+            m_impl_generics = nullptr;
         }
         
         void visit_type_impl(::HIR::TypeImpl& impl) override
         {
             TRACE_FUNCTION_F("impl " << impl.m_type);
-            auto _ = this->m_resolve.set_impl_generics(impl.m_params);
-            
+            assert( !m_impl_generics );
+            m_impl_generics = &impl.m_params;
             ::HIR::Visitor::visit_type_impl(impl);
+            m_impl_generics = nullptr;
         }
         void visit_trait_impl(const ::HIR::SimplePath& trait_path, ::HIR::TraitImpl& impl) override
         {
             TRACE_FUNCTION_F("impl " << trait_path << " for " << impl.m_type);
-            auto _ = this->m_resolve.set_impl_generics(impl.m_params);
-            
+            assert( !m_impl_generics );
+            m_impl_generics = &impl.m_params;
             ::HIR::Visitor::visit_trait_impl(trait_path, impl);
+            m_impl_generics = nullptr;
         }
     };
 }
 
+void HIR_Expand_AnnotateUsage_Expr(const ::HIR::Crate& crate, ::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, ::HIR::ExprPtr& exp, TypeEqualityCache* equality_cache)
+{
+    StaticTraitResolve  resolve { crate, impl_generics, item_generics, equality_cache };
+    ExprVisitor_Mark    ev { resolve };
+    ev.visit_root( exp );
+}
 void HIR_Expand_AnnotateUsage(::HIR::Crate& crate)
 {
     OuterVisitor    ov(crate);
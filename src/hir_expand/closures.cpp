@@ -9,6 +9,7 @@
 #include <hir/expr.hpp>
 #include <hir_typeck/static.hpp>
 #include <algorithm>
+#include <thread_pool.hpp>
 #include "main_bindings.hpp"
 
 namespace {
@@ -252,6 +253,8 @@ namespace {
 
         const StaticTraitResolve& m_resolve;
         const ::HIR::SimplePath&  m_module_path;
+        /// Path of the item that owns this body (prefixes closure type names)
+        const ::std::string&    m_owner_name;
         ::std::vector< ::HIR::TypeRef>& m_variable_types;
         
         // Outputs
@@ -260,13 +263,18 @@ namespace {
         
         /// Stack of active closures
         ::std::vector<ClosureScope> m_closure_stack;
+        /// Index of the next closure in this body (names only depend on the owner and visit order, so are the same
+        /// for any thread count)
+        unsigned int    m_next_closure_index;
     public:
-        ExprVisitor_Extract(const StaticTraitResolve& resolve, const ::HIR::SimplePath& mod_path, ::std::vector< ::HIR::TypeRef>& var_types, out_impls_t& out_impls, out_types_t& out_types):
+        ExprVisitor_Extract(const StaticTraitResolve& resolve, const ::HIR::SimplePath& mod_path, const ::std::string& owner_name, ::std::vector< ::HIR::TypeRef>& var_types, out_impls_t& out_impls, out_types_t& out_types):
             m_resolve(resolve),
             m_module_path(mod_path),
+            m_owner_name(owner_name),
             m_variable_types(var_types),
             m_out_impls( out_impls ),
-            m_out_types( out_types )
+            m_out_types( out_types ),
+            m_next_closure_index(0)
         {
         }
         
@@ -386,7 +394,7 @@ namespace {
                 capture_types.push_back( ::HIR::VisEnt< ::HIR::TypeRef> { false, mv$(ty_mono) } );
             }
             m_out_types.push_back( ::std::make_pair(
-                FMT("closure_" << &node),
+                FMT("closure#" << m_owner_name << "#" << m_next_closure_index ++),
                 ::HIR::Struct {
                     params.clone(),
                     ::HIR::Struct::Repr::Rust,
@@ -701,50 +709,60 @@ namespace {
     class OuterVisitor:
         public ::HIR::Visitor
     {
-        StaticTraitResolve  m_resolve;
-        out_impls_t m_new_trait_impls;
-        out_types_t m_new_types;
+        /// Function body to extract closures from, with the results of extraction
+        struct Body {
+            ::HIR::ExprPtr* code;
+            ::HIR::GenericParams*   impl_generics;
+            ::HIR::GenericParams*   item_generics;
+            /// Module that new closure types are placed into
+            const ::HIR::SimplePath*    mod_path;
+            /// Path of the owning item
+            ::std::string   owner_name;
+            
+            ClosureExpandOutput output;
+        };
+        
+        const ::HIR::Crate& m_crate;
+        ::HIR::GenericParams*   m_impl_generics;
+        ::HIR::GenericParams*   m_item_generics;
         const ::HIR::SimplePath*  m_cur_mod_path;
+        /// Owned storage for module paths (referenced by `Body::mod_path`)
+        ::std::vector< ::std::unique_ptr< ::HIR::SimplePath> >  m_mod_paths;
+        ::std::vector<Body> m_bodies;
+        TypeEqualityCache   m_equality_cache;
     public:
         OuterVisitor(const ::HIR::Crate& crate):
-            m_resolve(crate),
+            m_crate(crate),
+            m_impl_generics(nullptr),
+            m_item_generics(nullptr),
             m_cur_mod_path( nullptr )
         {}
         
         void visit_crate(::HIR::Crate& crate) override
         {
-            Span    sp;
             ::HIR::Visitor::visit_crate(crate);
             
-            for(auto& impl : m_new_trait_impls)
+            // Extract closures from all bodies (in parallel), then merge the results in visit order
+            parallel_for(m_bodies.size(), [&](unsigned int i) {
+                auto& body = m_bodies[i];
+                HIR_Expand_Closures_Expr(m_crate, body.impl_generics, body.item_generics, *body.mod_path, body.owner_name, *body.code, body.output, &m_equality_cache);
+                });
+            
+            for(auto& body : m_bodies)
             {
-                const auto& trait =
-                    impl.first == ::HIR::ExprNode_Closure::Class::Once ? crate.get_lang_item_path(sp, "fn_once")
-                    : impl.first == ::HIR::ExprNode_Closure::Class::Mut ? crate.get_lang_item_path(sp, "fn_mut")
-                    : /*impl.first == ::HIR::ExprNode_Closure::Class::Shared ?*/ crate.get_lang_item_path(sp, "fn")
-                    ;
-                crate.m_trait_impls.insert( ::std::make_pair(trait.clone(), mv$(impl.second)) );
+                HIR_Expand_Closures_Merge(crate, mv$(body.output));
             }
-            m_new_trait_impls.resize(0);
+            m_bodies.clear();
+            m_mod_paths.clear();
         }
         
         void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override
         {
             auto saved = m_cur_mod_path;
-            auto path = p.get_simple_path();
-            m_cur_mod_path = &path;
+            m_mod_paths.push_back( box$( p.get_simple_path() ) );
+            m_cur_mod_path = m_mod_paths.back().get();
             ::HIR::Visitor::visit_module(p, mod);
             m_cur_mod_path = saved;
-            
-            // - Insert newly created closure types
-            auto new_types = mv$(m_new_types);
-            for(auto& ty_def : new_types)
-            {
-                mod.m_mod_items.insert( ::std::make_pair(
-                    mv$(ty_def.first),
-                    box$(( ::HIR::VisEnt< ::HIR::TypeItem> { false, ::HIR::TypeItem(mv$(ty_def.second)) } ))
-                    ));
-            }
         }
         
         // NOTE: This is left here to ensure that any expressions that aren't handled by higher code cause a failure
@@ -772,13 +790,11 @@ namespace {
         // Code-containing items
         // ------
         void visit_function(::HIR::ItemPath p, ::HIR::Function& item) override {
-            auto _ = this->m_resolve.set_item_generics(item.m_params);
             if( item.m_code )
             {
                 assert( m_cur_mod_path );
                 DEBUG("Function code " << p);
-                ExprVisitor_Extract    ev(m_resolve, *m_cur_mod_path, item.m_code.m_bindings, m_new_trait_impls, m_new_types);
-                ev.visit_root( *item.m_code );
+                m_bodies.push_back( Body { &item.m_code, m_impl_generics, &item.m_params, m_cur_mod_path, FMT(p), {} } );
             }
             else
             {
@@ -818,30 +834,106 @@ namespace {
         
         void visit_trait(::HIR::ItemPath p, ::HIR::Trait& item) override
         {
-            auto _ = this->m_resolve.set_impl_generics(item.m_params);
+            assert( !m_impl_generics );
+            m_impl_generics = &item.m_params;
             ::HIR::Visitor::visit_trait(p, item);
+            m_impl_generics = nullptr;
         }
         
         
         void visit_type_impl(::HIR::TypeImpl& impl) override
         {
             TRACE_FUNCTION_F("impl " << impl.m_type);
-            auto _ = this->m_resolve.set_impl_generics(impl.m_params);
+            assert( !m_impl_generics );
+            m_impl_generics = &impl.m_params;
             m_cur_mod_path = &impl.m_src_module;
             
             ::HIR::Visitor::visit_type_impl(impl);
+            m_impl_generics = nullptr;
         }
         void visit_trait_impl(const ::HIR::SimplePath& trait_path, ::HIR::TraitImpl& impl) override
         {
             TRACE_FUNCTION_F("impl " << trait_path << " for " << impl.m_type);
-            auto _ = this->m_resolve.set_impl_generics(impl.m_params);
+            assert( !m_impl_generics );
+            m_impl_generics = &impl.m_params;
             m_cur_mod_path = &impl.m_src_module;
             
             ::HIR::Visitor::visit_trait_impl(trait_path, impl);
+            m_impl_generics = nullptr;
         }
     };
 }
 
+void HIR_Expand_Closures_Expr(const ::HIR::Crate& crate, ::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, const ::HIR::SimplePath& mod_path, const ::std::string& owner_name, ::HIR::ExprPtr& exp, ClosureExpandOutput& out, TypeEqualityCache* equality_cache)
+{
+    Span    sp;
+    StaticTraitResolve  resolve { crate, impl_generics, item_generics, equality_cache };
+    // NOTE: Extracted closure bodies share this body's node table
+    ::HIR::ExprNodeTable::Scope node_table { exp.node_table() };
+    
+    out_impls_t new_trait_impls;
+    out_types_t new_types;
+    ExprVisitor_Extract    ev(resolve, mod_path, owner_name, exp.m_bindings, new_trait_impls, new_types);
+    ev.visit_root( *exp );
+    
+    for(auto& impl : new_trait_impls)
+    {
+        const auto& trait =
+            impl.first == ::HIR::ExprNode_Closure::Class::Once ? crate.get_lang_item_path(sp, "fn_once")
+            : impl.first == ::HIR::ExprNode_Closure::Class::Mut ? crate.get_lang_item_path(sp, "fn_mut")
+            : /*impl.first == ::HIR::ExprNode_Closure::Class::Shared ?*/ crate.get_lang_item_path(sp, "fn")
+            ;
+        out.trait_impls.push_back( ::std::make_pair(trait.clone(), mv$(impl.second)) );
+    }
+    if( new_types.size() > 0 )
+    {
+        out.types.push_back( ClosureExpandOutput::Types { mod_path.clone(), mv$(new_types) } );
+    }
+}
+::std::vector< ::HIR::TraitImpl*> HIR_Expand_Closures_Merge(::HIR::Crate& crate, ClosureExpandOutput out)
+{
+    Span    sp;
+    ::std::vector< ::HIR::TraitImpl*>   rv;
+    for(auto& impl : out.trait_impls)
+    {
+        auto it = crate.m_trait_impls.insert( mv$(impl) );
+        rv.push_back( &it->second );
+    }
+    
+    // - Insert newly created closure types
+    for(auto& mod_types : out.types)
+    {
+        ::HIR::Module*  mod = &crate.m_root_module;
+        for( const auto& pc : mod_types.mod_path.m_components )
+        {
+            auto it = mod->m_mod_items.find( pc );
+            if( it == mod->m_mod_items.end() ) {
+                BUG(sp, "Couldn't find component " << pc << " of " << mod_types.mod_path);
+            }
+            TU_IFLET(::HIR::TypeItem, it->second->ent, Module, e,
+                mod = &e;
+            )
+            else {
+                BUG(sp, "Node " << pc << " of path " << mod_types.mod_path << " wasn't a module");
+            }
+        }
+        
+        for(auto& ty_def : mod_types.types)
+        {
+            auto path = mod_types.mod_path + ty_def.first;
+            auto ins = mod->m_mod_items.insert( ::std::make_pair(
+                mv$(ty_def.first),
+                box$(( ::HIR::VisEnt< ::HIR::TypeItem> { false, ::HIR::TypeItem(mv$(ty_def.second)) } ))
+                ));
+            if( !ins.second ) {
+                BUG(sp, "Closure type name " << path << " is already in use");
+            }
+            crate.add_to_path_index( mv$(path), ins.first->second->ent );
+        }
+    }
+    return rv;
+}
+
 void HIR_Expand_Closures(::HIR::Crate& crate)
 {
     OuterVisitor    ov(crate);
@@ -2,10 +2,33 @@
  */
 #pragma once
 
-namespace HIR {
-    class Crate;
-};
+#include <hir/hir.hpp>
+
+class TypeEqualityCache;
 
 extern void HIR_Expand_AnnotateUsage(::HIR::Crate& crate);
 extern void HIR_Expand_Closures(::HIR::Crate& crate);
 extern void HIR_Expand_UfcsEverything(::HIR::Crate& crate);
+
+// - Single-body versions of the above (used by the pipelined back half, see Typecheck_Expressions)
+
+/// Items created by extracting closures from expression bodies, to be added to the crate with `HIR_Expand_Closures_Merge`
+struct ClosureExpandOutput
+{
+    struct Types {
+        /// Module that the new types belong to
+        ::HIR::SimplePath   mod_path;
+        ::std::vector< ::std::pair< ::std::string, ::HIR::Struct> > types;
+    };
+    /// Closure types, grouped by module
+    ::std::vector<Types>    types;
+    /// Fn* impls for the above types (keyed by trait path)
+    ::std::vector< ::std::pair< ::HIR::SimplePath, ::HIR::TraitImpl> > trait_impls;
+};
+
+extern void HIR_Expand_AnnotateUsage_Expr(const ::HIR::Crate& crate, ::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, ::HIR::ExprPtr& exp, TypeEqualityCache* equality_cache=nullptr);
+/// `owner_name` is the path of the item owning `exp`, and is used to give the extracted closure types unique names
+extern void HIR_Expand_Closures_Expr(const ::HIR::Crate& crate, ::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, const ::HIR::SimplePath& mod_path, const ::std::string& owner_name, ::HIR::ExprPtr& exp, ClosureExpandOutput& out, TypeEqualityCache* equality_cache=nullptr);
+/// Returns the newly added impls
+extern ::std::vector< ::HIR::TraitImpl*> HIR_Expand_Closures_Merge(::HIR::Crate& crate, ClosureExpandOutput out);
+extern void HIR_Expand_UfcsEverything_Expr(const ::HIR::Crate& crate, ::HIR::ExprPtr& exp);
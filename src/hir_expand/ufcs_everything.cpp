@@ -9,6 +9,7 @@
 #include <hir/expr.hpp>
 #include <hir_typeck/static.hpp>
 #include <algorithm>
+#include <thread_pool.hpp>
 #include "main_bindings.hpp"
 
 namespace {
@@ -19,12 +20,15 @@ namespace {
 namespace {
     
     class ExprVisitor_Mutate:
-        public ::HIR::ExprVisitorDef
+        public ::HIR::ExprVisitorT<ExprVisitor_Mutate>
     {
+        typedef ::HIR::ExprVisitorT<ExprVisitor_Mutate> base_t;
         const ::HIR::Crate& m_crate;
         ::HIR::ExprNodeP    m_replacement;
         
     public:
+        using base_t::visit;
+
         ExprVisitor_Mutate(const ::HIR::Crate& crate):
             m_crate(crate)
         {
@@ -33,7 +37,7 @@ namespace {
             const auto& node_ref = *root;
             const char* node_ty = typeid(node_ref).name();
             TRACE_FUNCTION_FR(&*root << " " << node_ty << " : " << root->m_res_type, node_ty);
-            root->visit(*this);
+            ::HIR::visit_expr_node(*root, *this);
             if( m_replacement ) {
                 auto usage = root->m_usage;
                 const auto* ptr = m_replacement.get();
@@ -43,12 +47,12 @@ namespace {
             }
         }
         
-        void visit_node_ptr(::HIR::ExprNodeP& node) override {
+        void visit_node_ptr(::HIR::ExprNodeP& node) {
             const auto& node_ref = *node;
             const char* node_ty = typeid(node_ref).name();
             TRACE_FUNCTION_FR(&*node << " " << node_ty << " : " << node->m_res_type, node_ty);
             assert( node );
-            node->visit(*this);
+            ::HIR::visit_expr_node(*node, *this);
             if( m_replacement ) {
                 auto usage = node->m_usage;
                 const auto* ptr = m_replacement.get();
@@ -62,11 +66,11 @@ namespace {
         // _CallValue
         // ----------
         // Replace with a UFCS call using the now-known type
-        void visit(::HIR::ExprNode_CallValue& node) override
+        void visit(::HIR::ExprNode_CallValue& node)
         {
             const auto& sp = node.span();
             
-            ::HIR::ExprVisitorDef::visit(node);
+            base_t::visit(node);
             const auto& ty_val = node.m_value->m_res_type;
             
             // Calling a `fn` type should be kept as a _CallValue
@@ -172,11 +176,11 @@ namespace {
         // _CallMethod
         // ----------
         // Simple replacement
-        void visit(::HIR::ExprNode_CallMethod& node) override
+        void visit(::HIR::ExprNode_CallMethod& node)
         {
             const auto& sp = node.span();
             
-            ::HIR::ExprVisitorDef::visit(node);
+            base_t::visit(node);
             
             ::std::vector< ::HIR::ExprNodeP>    args;
             args.reserve( 1 + node.m_args.size() );
@@ -267,10 +271,10 @@ namespace {
         // _Assign
         // -------
         // Replace with overload call if not a builtin supported operation
-        void visit(::HIR::ExprNode_Assign& node) override
+        void visit(::HIR::ExprNode_Assign& node)
         {
             const auto& sp = node.span();
-            ::HIR::ExprVisitorDef::visit(node);
+            base_t::visit(node);
             
             const auto& ty_slot = node.m_slot->m_res_type;
             const auto& ty_val  = node.m_value->m_res_type;
@@ -337,10 +341,10 @@ namespace {
             arg_types.push_back( ::HIR::TypeRef::new_unit() );
         }
         
-        void visit(::HIR::ExprNode_BinOp& node) override
+        void visit(::HIR::ExprNode_BinOp& node)
         {
             const auto& sp = node.span();
-            ::HIR::ExprVisitorDef::visit(node);
+            base_t::visit(node);
             
             const auto& ty_l = node.m_left->m_res_type;
             const auto& ty_r  = node.m_right->m_res_type;
@@ -455,10 +459,10 @@ namespace {
             arg_types.push_back( m_replacement->m_res_type.clone() );
         }
         
-        void visit(::HIR::ExprNode_UniOp& node) override
+        void visit(::HIR::ExprNode_UniOp& node)
         {
             const auto& sp = node.span();
-            ::HIR::ExprVisitorDef::visit(node);
+            base_t::visit(node);
             
             const auto& ty_val = node.m_value->m_res_type;
             
@@ -532,10 +536,10 @@ namespace {
         }
         
         
-        void visit(::HIR::ExprNode_Index& node) override
+        void visit(::HIR::ExprNode_Index& node)
         {
             const auto& sp = node.span();
-            ::HIR::ExprVisitorDef::visit(node);
+            base_t::visit(node);
             
             const auto& ty_idx = node.m_index->m_res_type;
             const auto& ty_val = node.m_value->m_res_type;
@@ -610,11 +614,11 @@ namespace {
             m_replacement = NEWNODE( mv$(node.m_res_type), Deref, sp,  mv$(m_replacement) );
         }
         
-        void visit(::HIR::ExprNode_Deref& node) override
+        void visit(::HIR::ExprNode_Deref& node)
         {
             const auto& sp = node.span();
             
-            ::HIR::ExprVisitorDef::visit(node);
+            base_t::visit(node);
             
             const auto& ty_val = node.m_value->m_res_type;
             
@@ -681,12 +685,24 @@ namespace {
         public ::HIR::Visitor
     {
         const ::HIR::Crate& m_crate;
+        /// Expression bodies to be rewritten (done in parallel once all are known)
+        ::std::vector< ::HIR::ExprPtr*> m_bodies;
     public:
         OuterVisitor(const ::HIR::Crate& crate):
             m_crate(crate)
         {
         }
         
+        void visit_crate(::HIR::Crate& crate) override
+        {
+            ::HIR::Visitor::visit_crate(crate);
+            
+            parallel_for(m_bodies.size(), [&](unsigned int i) {
+                HIR_Expand_UfcsEverything_Expr(m_crate, *m_bodies[i]);
+                });
+            m_bodies.clear();
+        }
+        
         // NOTE: This is left here to ensure that any expressions that aren't handled by higher code cause a failure
         void visit_expr(::HIR::ExprPtr& exp) override {
             BUG(Span(), "visit_expr hit in OuterVisitor");
@@ -698,8 +714,7 @@ namespace {
                 this->visit_type( *e.inner );
                 DEBUG("Array size " << ty);
                 if( e.size ) {
-                    ExprVisitor_Mutate  ev(m_crate);
-                    ev.visit_node_ptr( e.size );
+                    m_bodies.push_back( &e.size );
                 }
             )
             else {
@@ -714,8 +729,7 @@ namespace {
             if( item.m_code )
             {
                 DEBUG("Function code " << p);
-                ExprVisitor_Mutate  ev(m_crate);
-                ev.visit_node_ptr( item.m_code );
+                m_bodies.push_back( &item.m_code );
             }
             else
             {
@@ -725,15 +739,13 @@ namespace {
         void visit_static(::HIR::ItemPath p, ::HIR::Static& item) override {
             if( item.m_value )
             {
-                ExprVisitor_Mutate  ev(m_crate);
-                ev.visit_node_ptr(item.m_value);
+                m_bodies.push_back( &item.m_value );
             }
         }
         void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
             if( item.m_value )
             {
-                ExprVisitor_Mutate  ev(m_crate);
-                ev.visit_node_ptr(item.m_value);
+                m_bodies.push_back( &item.m_value );
             }
         }
         void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
@@ -742,14 +754,19 @@ namespace {
                 TU_IFLET(::HIR::Enum::Variant, var.second, Value, e,
                     DEBUG("Enum value " << p << " - " << var.first);
                     
-                    ExprVisitor_Mutate  ev(m_crate);
-                    ev.visit_node_ptr(e);
+                    m_bodies.push_back( &e );
                 )
             }
         }
     };
 }   // namespace
 
+void HIR_Expand_UfcsEverything_Expr(const ::HIR::Crate& crate, ::HIR::ExprPtr& exp)
+{
+    ::HIR::ExprNodeTable::Scope node_table { exp.node_table() };
+    ExprVisitor_Mutate  ev(crate);
+    ev.visit_node_ptr( exp );
+}
 void HIR_Expand_UfcsEverything(::HIR::Crate& crate)
 {
     OuterVisitor    ov(crate);
@@ -0,0 +1,1733 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * hir_typeck/expr_cache.cpp
+ * - On-disk cache of typechecked expression trees
+ *
+ * Bodies are stored in a compact binary form (see Writer/Reader below), with pointers into the crate (struct/enum
+ * bindings, traits, constants) stored as the path and re-bound on load. Closure types refer to closure nodes by
+ * index within the body.
+ */
+#include "expr_cache.hpp"
+#include <cache_util.hpp>
+#include "expr_visit.hpp"
+#include <hir/expr.hpp>
+#include <hir/visitor.hpp>
+#include <fstream>
+#include <cstring>
+
+namespace {
+    /// Bumped whenever the stored format (or the typecheck output) changes
+    const uint32_t CACHE_VERSION = 1;
+    const char CACHE_MAGIC[] = "MRUSTC-TYPECK";
+
+    /// Thrown by the writer if a body can't be stored (e.g. refers to a closure from another body)
+    struct Uncacheable {
+        const char* reason;
+    };
+
+    enum NodeTag : uint8_t {
+        NODE_NULL,
+        NODE_Block,
+        NODE_Return,
+        NODE_Let,
+        NODE_Loop,
+        NODE_LoopControl,
+        NODE_Match,
+        NODE_If,
+        NODE_Assign,
+        NODE_BinOp,
+        NODE_UniOp,
+        NODE_Borrow,
+        NODE_Cast,
+        NODE_Unsize,
+        NODE_Index,
+        NODE_Deref,
+        NODE_TupleVariant,
+        NODE_CallPath,
+        NODE_CallValue,
+        NODE_CallMethod,
+        NODE_Field,
+        NODE_Literal,
+        NODE_UnitVariant,
+        NODE_PathValue,
+        NODE_Variable,
+        NODE_StructLiteral,
+        NODE_Tuple,
+        NODE_ArrayList,
+        NODE_ArraySized,
+        NODE_Closure,
+    };
+
+    // ----------------------------------------------------------------
+    // Serialisation
+    // ----------------------------------------------------------------
+    class Writer:
+        public ByteWriter,
+        public ::HIR::ExprVisitor
+    {
+        /// Line numbers are stored relative to this (so a body moving within the file doesn't change its key)
+        unsigned int    m_base_line;
+        /// Make each body's lines relative to its own start (only for hashing, as the reader can't reverse this)
+        bool    m_rebase_bodies;
+        RcString    m_last_filename;
+        ::std::map<const ::HIR::ExprNode_Closure*, unsigned int>  m_closures;
+    public:
+        Writer(::std::string& out, unsigned int base_line, bool rebase_bodies=false):
+            ByteWriter(out),
+            m_base_line(base_line),
+            m_rebase_bodies(rebase_bodies)
+        {}
+
+        void write_span(const Span& sp) {
+            if( sp.filename == m_last_filename.c_str() ) {
+                write_bool(false);
+            }
+            else {
+                write_bool(true);
+                write_string(sp.filename.c_str());
+                m_last_filename = sp.filename;
+            }
+            write_u64( static_cast<uint32_t>(sp.start_line - m_base_line) );
+            write_u64( sp.start_ofs );
+            write_u64( static_cast<uint32_t>(sp.end_line - m_base_line) );
+            write_u64( sp.end_ofs );
+        }
+
+        void write_simple_path(const ::HIR::SimplePath& path) {
+            write_string(path.m_crate_name);
+            write_count(path.m_components.size());
+            for(const auto& c : path.m_components)
+                write_string(c);
+        }
+        void write_path_params(const ::HIR::PathParams& pp) {
+            write_count(pp.m_types.size());
+            for(const auto& ty : pp.m_types)
+                write_type(ty);
+        }
+        void write_generic_path(const ::HIR::GenericPath& gp) {
+            write_simple_path(gp.m_path);
+            write_path_params(gp.m_params);
+        }
+        void write_trait_path(const ::HIR::TraitPath& tp) {
+            write_generic_path(tp.m_path);
+            write_count(tp.m_hrls.size());
+            for(const auto& l : tp.m_hrls)
+                write_string(l);
+            write_count(tp.m_type_bounds.size());
+            for(const auto& b : tp.m_type_bounds) {
+                write_string(b.first);
+                write_type(b.second);
+            }
+            write_bool(tp.m_trait_ptr != nullptr);
+        }
+        void write_path(const ::HIR::Path& path) {
+            write_u8( static_cast<uint8_t>(path.m_data.tag()) );
+            TU_MATCH(::HIR::Path::Data, (path.m_data), (e),
+            (Generic,
+                write_generic_path(e);
+                ),
+            (UfcsInherent,
+                write_type(*e.type);
+                write_string(e.item);
+                write_path_params(e.params);
+                ),
+            (UfcsKnown,
+                write_type(*e.type);
+                write_generic_path(e.trait);
+                write_string(e.item);
+                write_path_params(e.params);
+                ),
+            (UfcsUnknown,
+                write_type(*e.type);
+                write_string(e.item);
+                write_path_params(e.params);
+                )
+            )
+        }
+
+        void write_type(const ::HIR::TypeRef& ty) {
+            write_u8( static_cast<uint8_t>(ty.m_data.tag()) );
+            TU_MATCH(::HIR::TypeRef::Data, (ty.m_data), (e),
+            (Infer,
+                write_u64(e.index);
+                write_u8( static_cast<uint8_t>(e.ty_class) );
+                ),
+            (Diverge,
+                ),
+            (Primitive,
+                write_u8( static_cast<uint8_t>(e) );
+                ),
+            (Path,
+                write_path(e.path);
+                write_u8( static_cast<uint8_t>(e.binding.tag()) );
+                if( (e.binding.is_Struct() || e.binding.is_Enum()) && !e.path.m_data.is_Generic() )
+                    throw Uncacheable { "Bound type path isn't generic" };
+                ),
+            (Generic,
+                write_string(e.name);
+                write_u64(e.binding);
+                ),
+            (TraitObject,
+                write_trait_path(e.m_trait);
+                write_count(e.m_markers.size());
+                for(const auto& m : e.m_markers)
+                    write_generic_path(m);
+                write_string(e.m_lifetime.name);
+                ),
+            (Array,
+                write_type(*e.inner);
+                write_u64(e.size_val);
+                write_bool( static_cast<bool>(e.size) );
+                if( e.size )
+                    write_body( const_cast< ::HIR::ExprPtr&>(e.size) );
+                ),
+            (Slice,
+                write_type(*e.inner);
+                ),
+            (Tuple,
+                write_count(e.size());
+                for(const auto& st : e)
+                    write_type(st);
+                ),
+            (Borrow,
+                write_u8( static_cast<uint8_t>(e.type) );
+                write_type(*e.inner);
+                ),
+            (Pointer,
+                write_u8( static_cast<uint8_t>(e.type) );
+                write_type(*e.inner);
+                ),
+            (Function,
+                write_bool(e.is_unsafe);
+                write_string(e.m_abi);
+                write_type(*e.m_rettype);
+                write_count(e.m_arg_types.size());
+                for(const auto& at : e.m_arg_types)
+                    write_type(at);
+                ),
+            (Closure,
+                auto it = m_closures.find(e.node);
+                if( it == m_closures.end() )
+                    throw Uncacheable { "Closure type from outside the body" };
+                write_u64(it->second);
+                write_type(*e.m_rettype);
+                write_count(e.m_arg_types.size());
+                for(const auto& at : e.m_arg_types)
+                    write_type(at);
+                )
+            )
+        }
+
+        void write_pattern_binding(const ::HIR::PatternBinding& pb) {
+            write_bool(pb.m_mutable);
+            write_u8( static_cast<uint8_t>(pb.m_type) );
+            write_string(pb.m_name);
+            write_u64(pb.m_slot);
+        }
+        void write_pattern_value(const ::HIR::Pattern::Value& val) {
+            write_u8( static_cast<uint8_t>(val.tag()) );
+            TU_MATCH(::HIR::Pattern::Value, (val), (e),
+            (Integer,
+                write_u8( static_cast<uint8_t>(e.type) );
+                write_u64(e.value);
+                ),
+            (String,
+                write_string(e);
+                ),
+            (Named,
+                write_path(e.path);
+                write_bool(e.binding != nullptr);
+                if( e.binding && !e.path.m_data.is_Generic() )
+                    throw Uncacheable { "Bound constant path isn't generic" };
+                )
+            )
+        }
+        void write_patterns(const ::std::vector< ::HIR::Pattern>& pats) {
+            write_count(pats.size());
+            for(const auto& p : pats)
+                write_pattern(p);
+        }
+        void write_field_patterns(const ::std::vector< ::std::pair< ::std::string, ::HIR::Pattern> >& pats) {
+            write_count(pats.size());
+            for(const auto& p : pats) {
+                write_string(p.first);
+                write_pattern(p.second);
+            }
+        }
+        void write_pattern(const ::HIR::Pattern& pat) {
+            write_pattern_binding(pat.m_binding);
+            write_u8( static_cast<uint8_t>(pat.m_data.tag()) );
+            TU_MATCH(::HIR::Pattern::Data, (pat.m_data), (e),
+            (Any,
+                ),
+            (Box,
+                write_pattern(*e.sub);
+                ),
+            (Ref,
+                write_u8( static_cast<uint8_t>(e.type) );
+                write_pattern(*e.sub);
+                ),
+            (Tuple,
+                write_patterns(e.sub_patterns);
+                ),
+            (StructValue,
+                write_generic_path(e.path);
+                write_bool(e.binding != nullptr);
+                ),
+            (StructTuple,
+                write_generic_path(e.path);
+                write_bool(e.binding != nullptr);
+                write_patterns(e.sub_patterns);
+                ),
+            (StructTupleWildcard,
+                write_generic_path(e.path);
+                write_bool(e.binding != nullptr);
+                ),
+            (Struct,
+                write_generic_path(e.path);
+                write_bool(e.binding != nullptr);
+                write_field_patterns(e.sub_patterns);
+                write_bool(e.is_exhaustive);
+                ),
+            (Value,
+                write_pattern_value(e.val);
+                ),
+            (Range,
+                write_pattern_value(e.start);
+                write_pattern_value(e.end);
+                ),
+            (EnumValue,
+                write_generic_path(e.path);
+                write_bool(e.binding_ptr != nullptr);
+                write_u64(e.binding_idx);
+                ),
+            (EnumTuple,
+                write_generic_path(e.path);
+                write_bool(e.binding_ptr != nullptr);
+                write_u64(e.binding_idx);
+                write_patterns(e.sub_patterns);
+                ),
+            (EnumTupleWildcard,
+                write_generic_path(e.path);
+                write_bool(e.binding_ptr != nullptr);
+                write_u64(e.binding_idx);
+                ),
+            (EnumStruct,
+                write_generic_path(e.path);
+                write_bool(e.binding_ptr != nullptr);
+                write_u64(e.binding_idx);
+                write_field_patterns(e.sub_patterns);
+                write_bool(e.is_exhaustive);
+                ),
+            (Slice,
+                write_patterns(e.sub_patterns);
+                ),
+            (SplitSlice,
+                write_patterns(e.leading);
+                write_pattern_binding(e.extra_bind);
+                write_patterns(e.trailing);
+                )
+            )
+        }
+
+        void write_generic_params(const ::HIR::GenericParams& gps) {
+            write_count(gps.m_types.size());
+            for(const auto& tp : gps.m_types) {
+                write_string(tp.m_name);
+                write_type(tp.m_default);
+                write_bool(tp.m_is_sized);
+            }
+            write_count(gps.m_lifetimes.size());
+            for(const auto& lft : gps.m_lifetimes)
+                write_string(lft);
+            write_count(gps.m_bounds.size());
+            for(const auto& b : gps.m_bounds)
+            {
+                write_u8( static_cast<uint8_t>(b.tag()) );
+                TU_MATCH(::HIR::GenericBound, (b), (e),
+                (Lifetime,
+                    write_string(e.test);
+                    write_string(e.valid_for);
+                    ),
+                (TypeLifetime,
+                    write_type(e.type);
+                    write_string(e.valid_for);
+                    ),
+                (TraitBound,
+                    write_type(e.type);
+                    write_trait_path(e.trait);
+                    ),
+                (TypeEquality,
+                    write_type(e.type);
+                    write_type(e.other_type);
+                    )
+                )
+            }
+        }
+
+        /// Write an expression tree, along with its variable types
+        void write_body(::HIR::ExprPtr& expr) {
+            auto saved_base = m_base_line;
+            if( m_rebase_bodies )
+                m_base_line = expr->m_span.start_line;
+            // Number all closures up-front, as their types can be used before the closure node is reached
+            struct ClosureEnum:
+                public ::HIR::ExprVisitorDef
+            {
+                ::std::vector<const ::HIR::ExprNode_Closure*>   closures;
+                void visit(::HIR::ExprNode_Closure& node) override {
+                    closures.push_back(&node);
+                    ::HIR::ExprVisitorDef::visit(node);
+                }
+            };
+            ClosureEnum ce;
+            expr->visit(ce);
+            write_count(ce.closures.size());
+            for(const auto* c : ce.closures) {
+                auto idx = m_closures.size();
+                m_closures.insert( ::std::make_pair(c, idx) );
+            }
+
+            expr->visit(*this);
+            write_count(expr.m_bindings.size());
+            for(const auto& ty : expr.m_bindings)
+                write_type(ty);
+            m_base_line = saved_base;
+        }
+
+    private:
+        void write_node(::HIR::ExprNodeP& node) {
+            if( node )
+                node->visit(*this);
+            else
+                write_u8(NODE_NULL);
+        }
+        void write_nodes(::std::vector< ::HIR::ExprNodeP>& nodes) {
+            write_count(nodes.size());
+            for(auto& n : nodes)
+                write_node(n);
+        }
+        void write_types(const ::std::vector< ::HIR::TypeRef>& tys) {
+            write_count(tys.size());
+            for(const auto& ty : tys)
+                write_type(ty);
+        }
+        void write_header(NodeTag tag, const ::HIR::ExprNode& node) {
+            write_u8(tag);
+            write_span(node.m_span);
+            write_type(node.m_res_type);
+            write_u8( static_cast<uint8_t>(node.m_usage) );
+        }
+        void write_cache(const ::HIR::ExprCallCache& cache) {
+            // NOTE: The generic/monomorph pointers are only used during typecheck
+            write_types(cache.m_arg_types);
+            write_path_params(cache.m_ty_impl_params);
+        }
+
+    public:
+        void visit(::HIR::ExprNode_Block& node) override {
+            write_header(NODE_Block, node);
+            write_bool(node.m_is_unsafe);
+            write_nodes(node.m_nodes);
+            write_simple_path(node.m_local_mod);
+        }
+        void visit(::HIR::ExprNode_Return& node) override {
+            write_header(NODE_Return, node);
+            write_node(node.m_value);
+        }
+        void visit(::HIR::ExprNode_Let& node) override {
+            write_header(NODE_Let, node);
+            write_pattern(node.m_pattern);
+            write_type(node.m_type);
+            write_node(node.m_value);
+        }
+        void visit(::HIR::ExprNode_Loop& node) override {
+            write_header(NODE_Loop, node);
+            write_string(node.m_label);
+            write_node(node.m_code);
+        }
+        void visit(::HIR::ExprNode_LoopControl& node) override {
+            write_header(NODE_LoopControl, node);
+            write_string(node.m_label);
+            write_bool(node.m_continue);
+        }
+        void visit(::HIR::ExprNode_Match& node) override {
+            write_header(NODE_Match, node);
+            write_node(node.m_value);
+            write_count(node.m_arms.size());
+            for(auto& arm : node.m_arms) {
+                write_patterns(arm.m_patterns);
+                write_node(arm.m_cond);
+                write_node(arm.m_code);
+            }
+        }
+        void visit(::HIR::ExprNode_If& node) override {
+            write_header(NODE_If, node);
+            write_node(node.m_cond);
+            write_node(node.m_true);
+            write_node(node.m_false);
+        }
+
+        void visit(::HIR::ExprNode_Assign& node) override {
+            write_header(NODE_Assign, node);
+            write_u8( static_cast<uint8_t>(node.m_op) );
+            write_node(node.m_slot);
+            write_node(node.m_value);
+        }
+        void visit(::HIR::ExprNode_BinOp& node) override {
+            write_header(NODE_BinOp, node);
+            write_u8( static_cast<uint8_t>(node.m_op) );
+            write_node(node.m_left);
+            write_node(node.m_right);
+        }
+        void visit(::HIR::ExprNode_UniOp& node) override {
+            write_header(NODE_UniOp, node);
+            write_u8( static_cast<uint8_t>(node.m_op) );
+            write_node(node.m_value);
+        }
+        void visit(::HIR::ExprNode_Borrow& node) override {
+            write_header(NODE_Borrow, node);
+            write_u8( static_cast<uint8_t>(node.m_type) );
+            write_node(node.m_value);
+        }
+        void visit(::HIR::ExprNode_Cast& node) override {
+            write_header(NODE_Cast, node);
+            write_node(node.m_value);
+        }
+        void visit(::HIR::ExprNode_Unsize& node) override {
+            write_header(NODE_Unsize, node);
+            write_node(node.m_value);
+        }
+        void visit(::HIR::ExprNode_Index& node) override {
+            write_header(NODE_Index, node);
+            write_node(node.m_value);
+            write_node(node.m_index);
+        }
+        void visit(::HIR::ExprNode_Deref& node) override {
+            write_header(NODE_Deref, node);
+            write_node(node.m_value);
+        }
+
+        void visit(::HIR::ExprNode_TupleVariant& node) override {
+            write_header(NODE_TupleVariant, node);
+            write_generic_path(node.m_path);
+            write_bool(node.m_is_struct);
+            write_nodes(node.m_args);
+            write_types(node.m_arg_types);
+        }
+        void visit(::HIR::ExprNode_CallPath& node) override {
+            write_header(NODE_CallPath, node);
+            write_path(node.m_path);
+            write_nodes(node.m_args);
+            write_cache(node.m_cache);
+        }
+        void visit(::HIR::ExprNode_CallValue& node) override {
+            write_header(NODE_CallValue, node);
+            write_node(node.m_value);
+            write_nodes(node.m_args);
+            write_types(node.m_arg_types);
+            write_u8( static_cast<uint8_t>(node.m_trait_used) );
+        }
+        void visit(::HIR::ExprNode_CallMethod& node) override {
+            write_header(NODE_CallMethod, node);
+            write_node(node.m_value);
+            write_string(node.m_method);
+            write_path_params(node.m_params);
+            write_nodes(node.m_args);
+            write_path(node.m_method_path);
+            write_cache(node.m_cache);
+        }
+        void visit(::HIR::ExprNode_Field& node) override {
+            write_header(NODE_Field, node);
+            write_node(node.m_value);
+            write_string(node.m_field);
+        }
+
+        void visit(::HIR::ExprNode_Literal& node) override {
+            write_header(NODE_Literal, node);
+            write_u8( static_cast<uint8_t>(node.m_data.tag()) );
+            TU_MATCH(::HIR::ExprNode_Literal::Data, (node.m_data), (e),
+            (Integer,
+                write_u8( static_cast<uint8_t>(e.m_type) );
+                write_u64(e.m_value);
+                ),
+            (Float,
+                write_u8( static_cast<uint8_t>(e.m_type) );
+                uint64_t    bits;
+                static_assert(sizeof(bits) == sizeof(e.m_value), "");
+                ::std::memcpy(&bits, &e.m_value, sizeof(bits));
+                write_u64_raw(bits);
+                ),
+            (Boolean,
+                write_bool(e);
+                ),
+            (String,
+                write_string(e);
+                ),
+            (ByteString,
+                write_string( ::std::string(e.begin(), e.end()) );
+                )
+            )
+        }
+        void visit(::HIR::ExprNode_UnitVariant& node) override {
+            write_header(NODE_UnitVariant, node);
+            write_generic_path(node.m_path);
+            write_bool(node.m_is_struct);
+        }
+        void visit(::HIR::ExprNode_PathValue& node) override {
+            write_header(NODE_PathValue, node);
+            write_path(node.m_path);
+            write_u8( static_cast<uint8_t>(node.m_target) );
+        }
+        void visit(::HIR::ExprNode_Variable& node) override {
+            write_header(NODE_Variable, node);
+            write_string(node.m_name);
+            write_u64(node.m_slot);
+        }
+
+        void visit(::HIR::ExprNode_StructLiteral& node) override {
+            write_header(NODE_StructLiteral, node);
+            write_generic_path(node.m_path);
+            write_bool(node.m_is_struct);
+            write_node(node.m_base_value);
+            write_count(node.m_values.size());
+            for(auto& val : node.m_values) {
+                write_string(val.first);
+                write_node(val.second);
+            }
+            write_types(node.m_value_types);
+        }
+        void visit(::HIR::ExprNode_Tuple& node) override {
+            write_header(NODE_Tuple, node);
+            write_nodes(node.m_vals);
+        }
+        void visit(::HIR::ExprNode_ArrayList& node) override {
+            write_header(NODE_ArrayList, node);
+            write_nodes(node.m_vals);
+        }
+        void visit(::HIR::ExprNode_ArraySized& node) override {
+            write_header(NODE_ArraySized, node);
+            write_node(node.m_val);
+            write_node(node.m_size);
+            write_u64(node.m_size_val);
+        }
+
+        void visit(::HIR::ExprNode_Closure& node) override {
+            write_header(NODE_Closure, node);
+            write_u64( m_closures.at(&node) );
+            write_count(node.m_args.size());
+            for(const auto& arg : node.m_args) {
+                write_pattern(arg.first);
+                write_type(arg.second);
+            }
+            write_type(node.m_return);
+            write_node(node.m_code);
+            write_u8( static_cast<uint8_t>(node.m_class) );
+            write_bool(node.m_is_move);
+            write_count(node.m_var_captures.size());
+            for(auto slot : node.m_var_captures)
+                write_u64(slot);
+            write_generic_path(node.m_obj_path);
+        }
+    };
+
+    // ----------------------------------------------------------------
+    // Deserialisation
+    // ----------------------------------------------------------------
+    class Reader:
+        public ByteReader
+    {
+        const ::HIR::Crate& m_crate;
+        unsigned int    m_base_line;
+        RcString    m_last_filename;
+        /// Closure nodes (allocated when the owning body is started)
+        ::std::vector< ::HIR::ExprNode_Closure*>  m_closures;
+        ::std::vector< ::std::unique_ptr< ::HIR::ExprNode_Closure> >  m_closure_storage;
+        /// Span used for item lookups
+        Span    m_sp;
+    public:
+        Reader(const ::HIR::Crate& crate, const ::std::string& buf, unsigned int base_line):
+            ByteReader(buf),
+            m_crate(crate),
+            m_base_line(base_line),
+            m_sp(RcString(), 0,0, 0,0)
+        {}
+
+        template<typename T>
+        T read_tag(unsigned int max) {
+            auto v = read_u8();
+            if( v > max )
+                throw CacheReadFailure {};
+            return static_cast<T>(v);
+        }
+
+        Span read_span() {
+            if( read_bool() ) {
+                m_last_filename = RcString(read_string());
+            }
+            unsigned int start_line = static_cast<uint32_t>(read_u64()) + m_base_line;
+            unsigned int start_ofs  = static_cast<uint32_t>(read_u64());
+            unsigned int end_line   = static_cast<uint32_t>(read_u64()) + m_base_line;
+            unsigned int end_ofs    = static_cast<uint32_t>(read_u64());
+            return Span(m_last_filename, start_line, start_ofs, end_line, end_ofs);
+        }
+
+        ::HIR::SimplePath read_simple_path() {
+            ::HIR::SimplePath   rv { read_string() };
+            auto count = read_count();
+            rv.m_components.reserve(count);
+            for(size_t i = 0; i < count; i ++)
+                rv.m_components.push_back( read_string() );
+            return rv;
+        }
+        ::HIR::PathParams read_path_params() {
+            ::HIR::PathParams   rv;
+            rv.m_types = read_types();
+            return rv;
+        }
+        ::HIR::GenericPath read_generic_path() {
+            auto sp = read_simple_path();
+            auto pp = read_path_params();
+            return ::HIR::GenericPath( mv$(sp), mv$(pp) );
+        }
+        ::HIR::TraitPath read_trait_path() {
+            ::HIR::TraitPath    rv;
+            rv.m_path = read_generic_path();
+            auto hrl_count = read_count();
+            for(size_t i = 0; i < hrl_count; i ++)
+                rv.m_hrls.push_back( read_string() );
+            auto bound_count = read_count();
+            for(size_t i = 0; i < bound_count; i ++) {
+                auto name = read_string();
+                rv.m_type_bounds.insert( ::std::make_pair( mv$(name), read_type() ) );
+            }
+            rv.m_trait_ptr = read_bool() ? &m_crate.get_trait_by_path(m_sp, rv.m_path.m_path) : nullptr;
+            return rv;
+        }
+        ::HIR::Path read_path() {
+            switch( read_tag< ::HIR::Path::Data::Tag>(::HIR::Path::Data::TAG_UfcsUnknown) )
+            {
+            case ::HIR::Path::Data::TAG_Generic:
+                return ::HIR::Path( read_generic_path() );
+            case ::HIR::Path::Data::TAG_UfcsInherent: {
+                auto ty = read_type();
+                auto item = read_string();
+                auto params = read_path_params();
+                return ::HIR::Path::Data::make_UfcsInherent({ box$(ty), mv$(item), mv$(params) });
+                }
+            case ::HIR::Path::Data::TAG_UfcsKnown: {
+                auto ty = read_type();
+                auto trait = read_generic_path();
+                auto item = read_string();
+                auto params = read_path_params();
+                return ::HIR::Path::Data::make_UfcsKnown({ box$(ty), mv$(trait), mv$(item), mv$(params) });
+                }
+            case ::HIR::Path::Data::TAG_UfcsUnknown: {
+                auto ty = read_type();
+                auto item = read_string();
+                auto params = read_path_params();
+                return ::HIR::Path::Data::make_UfcsUnknown({ box$(ty), mv$(item), mv$(params) });
+                }
+            default:
+                throw CacheReadFailure {};
+            }
+        }
+
+        ::std::vector< ::HIR::TypeRef> read_types() {
+            auto count = read_count();
+            ::std::vector< ::HIR::TypeRef>  rv;
+            rv.reserve(count);
+            for(size_t i = 0; i < count; i ++)
+                rv.push_back( read_type() );
+            return rv;
+        }
+        ::HIR::TypeRef read_type() {
+            typedef ::HIR::TypeRef::Data    Data;
+            switch( read_tag<Data::Tag>(Data::TAG_Closure) )
+            {
+            case Data::TAG_Infer: {
+                auto idx = static_cast<unsigned int>(read_u64());
+                auto cls = read_tag< ::HIR::InferClass>( static_cast<unsigned int>(::HIR::InferClass::Float) );
+                return Data::make_Infer({ idx, cls });
+                }
+            case Data::TAG_Diverge:
+                return ::HIR::TypeRef::new_diverge();
+            case Data::TAG_Primitive:
+                return read_tag< ::HIR::CoreType>( static_cast<unsigned int>(::HIR::CoreType::Str) );
+            case Data::TAG_Path: {
+                auto path = read_path();
+                ::HIR::TypeRef::TypePathBinding pb;
+                switch( read_tag< ::HIR::TypeRef::TypePathBinding::Tag>(::HIR::TypeRef::TypePathBinding::TAG_Enum) )
+                {
+                case ::HIR::TypeRef::TypePathBinding::TAG_Unbound:
+                    pb = ::HIR::TypeRef::TypePathBinding::make_Unbound({});
+                    break;
+                case ::HIR::TypeRef::TypePathBinding::TAG_Opaque:
+                    pb = ::HIR::TypeRef::TypePathBinding::make_Opaque({});
+                    break;
+                case ::HIR::TypeRef::TypePathBinding::TAG_Struct:
+                    if( !path.m_data.is_Generic() )
+                        throw CacheReadFailure {};
+                    pb = ::HIR::TypeRef::TypePathBinding::make_Struct( &m_crate.get_struct_by_path(m_sp, path.m_data.as_Generic().m_path) );
+                    break;
+                case ::HIR::TypeRef::TypePathBinding::TAG_Enum:
+                    if( !path.m_data.is_Generic() )
+                        throw CacheReadFailure {};
+                    pb = ::HIR::TypeRef::TypePathBinding::make_Enum( &m_crate.get_enum_by_path(m_sp, path.m_data.as_Generic().m_path) );
+                    break;
+                default:
+                    throw CacheReadFailure {};
+                }
+                return ::HIR::TypeRef::new_path( mv$(path), mv$(pb) );
+                }
+            case Data::TAG_Generic: {
+                auto name = read_string();
+                auto binding = static_cast<unsigned int>(read_u64());
+                return ::HIR::TypeRef( mv$(name), binding );
+                }
+            case Data::TAG_TraitObject: {
+                auto trait = read_trait_path();
+                auto marker_count = read_count();
+                ::std::vector< ::HIR::GenericPath>  markers;
+                for(size_t i = 0; i < marker_count; i ++)
+                    markers.push_back( read_generic_path() );
+                auto lifetime = read_string();
+                return Data::make_TraitObject({ mv$(trait), mv$(markers), ::HIR::LifetimeRef { mv$(lifetime) } });
+                }
+            case Data::TAG_Array: {
+                auto inner = read_type();
+                size_t size_val = read_u64();
+                ::HIR::ExprPtr  size;
+                if( read_bool() )
+                    read_body(size);
+                return Data::make_Array({ box$(inner), mv$(size), size_val });
+                }
+            case Data::TAG_Slice:
+                return ::HIR::TypeRef::new_slice( read_type() );
+            case Data::TAG_Tuple:
+                return ::HIR::TypeRef( read_types() );
+            case Data::TAG_Borrow: {
+                auto bt = read_tag< ::HIR::BorrowType>( static_cast<unsigned int>(::HIR::BorrowType::Owned) );
+                return ::HIR::TypeRef::new_borrow( bt, read_type() );
+                }
+            case Data::TAG_Pointer: {
+                auto bt = read_tag< ::HIR::BorrowType>( static_cast<unsigned int>(::HIR::BorrowType::Owned) );
+                return ::HIR::TypeRef::new_pointer( bt, read_type() );
+                }
+            case Data::TAG_Function: {
+                ::HIR::FunctionType ft;
+                ft.is_unsafe = read_bool();
+                ft.m_abi = read_string();
+                ft.m_rettype = box$( read_type() );
+                ft.m_arg_types = read_types();
+                return Data::make_Function( mv$(ft) );
+                }
+            case Data::TAG_Closure: {
+                auto idx = read_u64();
+                if( idx >= m_closures.size() )
+                    throw CacheReadFailure {};
+                auto rv = read_type();
+                auto args = read_types();
+                return ::HIR::TypeRef::new_closure( m_closures[idx], mv$(args), mv$(rv) );
+                }
+            default:
+                throw CacheReadFailure {};
+            }
+        }
+
+        ::HIR::PatternBinding read_pattern_binding() {
+            auto is_mut = read_bool();
+            auto ty = read_tag< ::HIR::PatternBinding::Type>( static_cast<unsigned int>(::HIR::PatternBinding::Type::MutRef) );
+            auto name = read_string();
+            auto slot = static_cast<unsigned int>(read_u64());
+            return ::HIR::PatternBinding(is_mut, ty, mv$(name), slot);
+        }
+        ::HIR::Pattern::Value read_pattern_value() {
+            typedef ::HIR::Pattern::Value   Value;
+            switch( read_tag<Value::Tag>(Value::TAG_Named) )
+            {
+            case Value::TAG_Integer: {
+                auto ty = read_tag< ::HIR::CoreType>( static_cast<unsigned int>(::HIR::CoreType::Str) );
+                auto v = read_u64();
+                return Value::make_Integer({ ty, v });
+                }
+            case Value::TAG_String:
+                return Value::make_String( read_string() );
+            case Value::TAG_Named: {
+                auto path = read_path();
+                const ::HIR::Constant*  binding = nullptr;
+                if( read_bool() ) {
+                    if( !path.m_data.is_Generic() )
+                        throw CacheReadFailure {};
+                    binding = &m_crate.get_constant_by_path(m_sp, path.m_data.as_Generic().m_path);
+                }
+                return Value::make_Named({ mv$(path), binding });
+                }
+            default:
+                throw CacheReadFailure {};
+            }
+        }
+        ::std::vector< ::HIR::Pattern> read_patterns() {
+            auto count = read_count();
+            ::std::vector< ::HIR::Pattern>  rv;
+            rv.reserve(count);
+            for(size_t i = 0; i < count; i ++)
+                rv.push_back( read_pattern() );
+            return rv;
+        }
+        ::std::vector< ::std::pair< ::std::string, ::HIR::Pattern> > read_field_patterns() {
+            auto count = read_count();
+            ::std::vector< ::std::pair< ::std::string, ::HIR::Pattern> >    rv;
+            rv.reserve(count);
+            for(size_t i = 0; i < count; i ++) {
+                auto name = read_string();
+                rv.push_back( ::std::make_pair( mv$(name), read_pattern() ) );
+            }
+            return rv;
+        }
+        const ::HIR::Struct* read_struct_binding(const ::HIR::GenericPath& path) {
+            return read_bool() ? &m_crate.get_struct_by_path(m_sp, path.m_path) : nullptr;
+        }
+        const ::HIR::Enum* read_enum_binding(const ::HIR::GenericPath& path) {
+            if( !read_bool() )
+                return nullptr;
+            // - Enum path is the variant path without the variant name
+            auto enum_path = path.m_path.clone();
+            if( enum_path.m_components.empty() )
+                throw CacheReadFailure {};
+            enum_path.m_components.pop_back();
+            return &m_crate.get_enum_by_path(m_sp, enum_path);
+        }
+        ::HIR::Pattern read_pattern() {
+            typedef ::HIR::Pattern::Data    Data;
+            auto pb = read_pattern_binding();
+            switch( read_tag<Data::Tag>(Data::TAG_SplitSlice) )
+            {
+            case Data::TAG_Any:
+                return ::HIR::Pattern( mv$(pb), Data::make_Any({}) );
+            case Data::TAG_Box:
+                return ::HIR::Pattern( mv$(pb), Data::make_Box({ box$(read_pattern()) }) );
+            case Data::TAG_Ref: {
+                auto bt = read_tag< ::HIR::BorrowType>( static_cast<unsigned int>(::HIR::BorrowType::Owned) );
+                return ::HIR::Pattern( mv$(pb), Data::make_Ref({ bt, box$(read_pattern()) }) );
+                }
+            case Data::TAG_Tuple:
+                return ::HIR::Pattern( mv$(pb), Data::make_Tuple({ read_patterns() }) );
+            case Data::TAG_StructValue: {
+                auto path = read_generic_path();
+                auto binding = read_struct_binding(path);
+                return ::HIR::Pattern( mv$(pb), Data::make_StructValue({ mv$(path), binding }) );
+                }
+            case Data::TAG_StructTuple: {
+                auto path = read_generic_path();
+                auto binding = read_struct_binding(path);
+                auto subpats = read_patterns();
+                return ::HIR::Pattern( mv$(pb), Data::make_StructTuple({ mv$(path), binding, mv$(subpats) }) );
+                }
+            case Data::TAG_StructTupleWildcard: {
+                auto path = read_generic_path();
+                auto binding = read_struct_binding(path);
+                return ::HIR::Pattern( mv$(pb), Data::make_StructTupleWildcard({ mv$(path), binding }) );
+                }
+            case Data::TAG_Struct: {
+                auto path = read_generic_path();
+                auto binding = read_struct_binding(path);
+                auto subpats = read_field_patterns();
+                auto is_exhaustive = read_bool();
+                return ::HIR::Pattern( mv$(pb), Data::make_Struct({ mv$(path), binding, mv$(subpats), is_exhaustive }) );
+                }
+            case Data::TAG_Value:
+                return ::HIR::Pattern( mv$(pb), Data::make_Value({ read_pattern_value() }) );
+            case Data::TAG_Range: {
+                auto start = read_pattern_value();
+                auto end = read_pattern_value();
+                return ::HIR::Pattern( mv$(pb), Data::make_Range({ mv$(start), mv$(end) }) );
+                }
+            case Data::TAG_EnumValue: {
+                auto path = read_generic_path();
+                auto binding = read_enum_binding(path);
+                auto idx = static_cast<unsigned>(read_u64());
+                return ::HIR::Pattern( mv$(pb), Data::make_EnumValue({ mv$(path), binding, idx }) );
+                }
+            case Data::TAG_EnumTuple: {
+                auto path = read_generic_path();
+                auto binding = read_enum_binding(path);
+                auto idx = static_cast<unsigned>(read_u64());
+                auto subpats = read_patterns();
+                return ::HIR::Pattern( mv$(pb), Data::make_EnumTuple({ mv$(path), binding, idx, mv$(subpats) }) );
+                }
+            case Data::TAG_EnumTupleWildcard: {
+                auto path = read_generic_path();
+                auto binding = read_enum_binding(path);
+                auto idx = static_cast<unsigned>(read_u64());
+                return ::HIR::Pattern( mv$(pb), Data::make_EnumTupleWildcard({ mv$(path), binding, idx }) );
+                }
+            case Data::TAG_EnumStruct: {
+                auto path = read_generic_path();
+                auto binding = read_enum_binding(path);
+                auto idx = static_cast<unsigned>(read_u64());
+                auto subpats = read_field_patterns();
+                auto is_exhaustive = read_bool();
+                return ::HIR::Pattern( mv$(pb), Data::make_EnumStruct({ mv$(path), binding, idx, mv$(subpats), is_exhaustive }) );
+                }
+            case Data::TAG_Slice:
+                return ::HIR::Pattern( mv$(pb), Data::make_Slice({ read_patterns() }) );
+            case Data::TAG_SplitSlice: {
+                auto leading = read_patterns();
+                auto extra = read_pattern_binding();
+                auto trailing = read_patterns();
+                return ::HIR::Pattern( mv$(pb), Data::make_SplitSlice({ mv$(leading), mv$(extra), mv$(trailing) }) );
+                }
+            default:
+                throw CacheReadFailure {};
+            }
+        }
+
+        void read_body(::HIR::ExprPtr& out) {
+            ::HIR::ExprNodeTable::Scope node_table { ::std::make_shared< ::HIR::ExprNodeTable>() };
+            auto closure_count = read_count();
+            for(size_t i = 0; i < closure_count; i ++)
+            {
+                auto* node = new ::HIR::ExprNode_Closure(Span(m_sp), {}, ::HIR::TypeRef(), nullptr);
+                m_closure_storage.push_back( ::std::unique_ptr< ::HIR::ExprNode_Closure>(node) );
+                m_closures.push_back( node );
+            }
+
+            auto root = read_node();
+            if( !root )
+                throw CacheReadFailure {};
+            ::HIR::ExprPtr  rv { mv$(root) };
+            rv.m_bindings = read_types();
+            out = mv$(rv);
+        }
+        /// Check that all closures were placed in the tree
+        void finish() {
+            if( !at_end() )
+                throw CacheReadFailure {};
+            for(const auto& c : m_closure_storage)
+                if( c )
+                    throw CacheReadFailure {};
+        }
+
+    private:
+        ::std::vector< ::HIR::ExprNodeP> read_nodes() {
+            auto count = read_count();
+            ::std::vector< ::HIR::ExprNodeP>    rv;
+            rv.reserve(count);
+            for(size_t i = 0; i < count; i ++)
+                rv.push_back( read_node() );
+            return rv;
+        }
+        void read_cache(::HIR::ExprCallCache& cache) {
+            cache.m_arg_types = read_types();
+            cache.m_ty_impl_params = read_path_params();
+            cache.m_fcn_params = nullptr;
+            cache.m_top_params = nullptr;
+        }
+
+        ::HIR::ExprNodeP read_node() {
+            auto tag = read_tag<NodeTag>(NODE_Closure);
+            if( tag == NODE_NULL )
+                return ::HIR::ExprNodeP();
+            auto sp = read_span();
+            auto res_type = read_type();
+            auto usage = read_tag< ::HIR::ValueUsage>( static_cast<unsigned int>(::HIR::ValueUsage::Move) );
+
+            ::HIR::ExprNodeP    rv;
+            switch(tag)
+            {
+            case NODE_NULL:
+                break;
+            case NODE_Block: {
+                auto is_unsafe = read_bool();
+                auto nodes = read_nodes();
+                auto* node = new ::HIR::ExprNode_Block(mv$(sp), is_unsafe, mv$(nodes));
+                rv.reset(node);
+                node->m_local_mod = read_simple_path();
+                } break;
+            case NODE_Return:
+                rv.reset( new ::HIR::ExprNode_Return(mv$(sp), read_node()) );
+                break;
+            case NODE_Let: {
+                auto pat = read_pattern();
+                auto ty = read_type();
+                auto val = read_node();
+                rv.reset( new ::HIR::ExprNode_Let(mv$(sp), mv$(pat), mv$(ty), mv$(val)) );
+                } break;
+            case NODE_Loop: {
+                auto label = read_string();
+                auto code = read_node();
+                rv.reset( new ::HIR::ExprNode_Loop(mv$(sp), mv$(label), mv$(code)) );
+                } break;
+            case NODE_LoopControl: {
+                auto label = read_string();
+                auto cont = read_bool();
+                rv.reset( new ::HIR::ExprNode_LoopControl(mv$(sp), mv$(label), cont) );
+                } break;
+            case NODE_Match: {
+                auto val = read_node();
+                auto arm_count = read_count();
+                ::std::vector< ::HIR::ExprNode_Match::Arm>  arms;
+                arms.reserve(arm_count);
+                for(size_t i = 0; i < arm_count; i ++)
+                {
+                    auto pats = read_patterns();
+                    auto cond = read_node();
+                    auto code = read_node();
+                    arms.push_back( ::HIR::ExprNode_Match::Arm { mv$(pats), mv$(cond), mv$(code) } );
+                }
+                rv.reset( new ::HIR::ExprNode_Match(mv$(sp), mv$(val), mv$(arms)) );
+                } break;
+            case NODE_If: {
+                auto cond = read_node();
+                auto true_code = read_node();
+                auto false_code = read_node();
+                rv.reset( new ::HIR::ExprNode_If(mv$(sp), mv$(cond), mv$(true_code), mv$(false_code)) );
+                } break;
+
+            case NODE_Assign: {
+                auto op = read_tag< ::HIR::ExprNode_Assign::Op>( static_cast<unsigned int>(::HIR::ExprNode_Assign::Op::Shl) );
+                auto slot = read_node();
+                auto val = read_node();
+                rv.reset( new ::HIR::ExprNode_Assign(mv$(sp), op, mv$(slot), mv$(val)) );
+                } break;
+            case NODE_BinOp: {
+                auto op = read_tag< ::HIR::ExprNode_BinOp::Op>( static_cast<unsigned int>(::HIR::ExprNode_BinOp::Op::Shl) );
+                auto left = read_node();
+                auto right = read_node();
+                rv.reset( new ::HIR::ExprNode_BinOp(mv$(sp), op, mv$(left), mv$(right)) );
+                } break;
+            case NODE_UniOp: {
+                auto op = read_tag< ::HIR::ExprNode_UniOp::Op>( static_cast<unsigned int>(::HIR::ExprNode_UniOp::Op::Negate) );
+                rv.reset( new ::HIR::ExprNode_UniOp(mv$(sp), op, read_node()) );
+                } break;
+            case NODE_Borrow: {
+                auto bt = read_tag< ::HIR::BorrowType>( static_cast<unsigned int>(::HIR::BorrowType::Owned) );
+                rv.reset( new ::HIR::ExprNode_Borrow(mv$(sp), bt, read_node()) );
+                } break;
+            case NODE_Cast:
+                rv.reset( new ::HIR::ExprNode_Cast(mv$(sp), read_node(), ::HIR::TypeRef()) );
+                break;
+            case NODE_Unsize:
+                rv.reset( new ::HIR::ExprNode_Unsize(mv$(sp), read_node(), ::HIR::TypeRef()) );
+                break;
+            case NODE_Index: {
+                auto val = read_node();
+                auto idx = read_node();
+                rv.reset( new ::HIR::ExprNode_Index(mv$(sp), mv$(val), mv$(idx)) );
+                } break;
+            case NODE_Deref:
+                rv.reset( new ::HIR::ExprNode_Deref(mv$(sp), read_node()) );
+                break;
+
+            case NODE_TupleVariant: {
+                auto path = read_generic_path();
+                auto is_struct = read_bool();
+                auto args = read_nodes();
+                auto* node = new ::HIR::ExprNode_TupleVariant(mv$(sp), mv$(path), is_struct, mv$(args));
+                rv.reset(node);
+                node->m_arg_types = read_types();
+                } break;
+            case NODE_CallPath: {
+                auto path = read_path();
+                auto args = read_nodes();
+                auto* node = new ::HIR::ExprNode_CallPath(mv$(sp), mv$(path), mv$(args));
+                rv.reset(node);
+                read_cache(node->m_cache);
+                } break;
+            case NODE_CallValue: {
+                auto val = read_node();
+                auto args = read_nodes();
+                auto* node = new ::HIR::ExprNode_CallValue(mv$(sp), mv$(val), mv$(args));
+                rv.reset(node);
+                node->m_arg_types = read_types();
+                node->m_trait_used = read_tag< ::HIR::ExprNode_CallValue::TraitUsed>( static_cast<unsigned int>(::HIR::ExprNode_CallValue::TraitUsed::FnOnce) );
+                } break;
+            case NODE_CallMethod: {
+                auto val = read_node();
+                auto method = read_string();
+                auto params = read_path_params();
+                auto args = read_nodes();
+                auto* node = new ::HIR::ExprNode_CallMethod(mv$(sp), mv$(val), mv$(method), mv$(params), mv$(args));
+                rv.reset(node);
+                node->m_method_path = read_path();
+                read_cache(node->m_cache);
+                } break;
+            case NODE_Field: {
+                auto val = read_node();
+                auto field = read_string();
+                rv.reset( new ::HIR::ExprNode_Field(mv$(sp), mv$(val), mv$(field)) );
+                } break;
+
+            case NODE_Literal: {
+                typedef ::HIR::ExprNode_Literal::Data   Data;
+                Data    data;
+                switch( read_tag<Data::Tag>(Data::TAG_ByteString) )
+                {
+                case Data::TAG_Integer: {
+                    auto ty = read_tag< ::HIR::CoreType>( static_cast<unsigned int>(::HIR::CoreType::Str) );
+                    auto v = read_u64();
+                    data = Data::make_Integer({ ty, v });
+                    } break;
+                case Data::TAG_Float: {
+                    auto ty = read_tag< ::HIR::CoreType>( static_cast<unsigned int>(::HIR::CoreType::Str) );
+                    auto bits = read_u64_raw();
+                    double  v;
+                    ::std::memcpy(&v, &bits, sizeof(v));
+                    data = Data::make_Float({ ty, v });
+                    } break;
+                case Data::TAG_Boolean:
+                    data = Data::make_Boolean( read_bool() );
+                    break;
+                case Data::TAG_String:
+                    data = Data::make_String( read_string() );
+                    break;
+                case Data::TAG_ByteString: {
+                    auto s = read_string();
+                    data = Data::make_ByteString( ::std::vector<char>(s.begin(), s.end()) );
+                    } break;
+                default:
+                    throw CacheReadFailure {};
+                }
+                rv.reset( new ::HIR::ExprNode_Literal(mv$(sp), mv$(data)) );
+                } break;
+            case NODE_UnitVariant: {
+                auto path = read_generic_path();
+                auto is_struct = read_bool();
+                rv.reset( new ::HIR::ExprNode_UnitVariant(mv$(sp), mv$(path), is_struct) );
+                } break;
+            case NODE_PathValue: {
+                auto path = read_path();
+                auto target = read_tag< ::HIR::ExprNode_PathValue::Target>( ::HIR::ExprNode_PathValue::CONSTANT );
+                rv.reset( new ::HIR::ExprNode_PathValue(mv$(sp), mv$(path), target) );
+                } break;
+            case NODE_Variable: {
+                auto name = read_string();
+                auto slot = static_cast<unsigned int>(read_u64());
+                rv.reset( new ::HIR::ExprNode_Variable(mv$(sp), mv$(name), slot) );
+                } break;
+
+            case NODE_StructLiteral: {
+                auto path = read_generic_path();
+                auto is_struct = read_bool();
+                auto base_value = read_node();
+                auto value_count = read_count();
+                ::HIR::ExprNode_StructLiteral::t_values values;
+                values.reserve(value_count);
+                for(size_t i = 0; i < value_count; i ++)
+                {
+                    auto name = read_string();
+                    values.push_back( ::std::make_pair( mv$(name), read_node() ) );
+                }
+                auto* node = new ::HIR::ExprNode_StructLiteral(mv$(sp), mv$(path), is_struct, mv$(base_value), mv$(values));
+                rv.reset(node);
+                node->m_value_types = read_types();
+                } break;
+            case NODE_Tuple:
+                rv.reset( new ::HIR::ExprNode_Tuple(mv$(sp), read_nodes()) );
+                break;
+            case NODE_ArrayList:
+                rv.reset( new ::HIR::ExprNode_ArrayList(mv$(sp), read_nodes()) );
+                break;
+            case NODE_ArraySized: {
+                auto val = read_node();
+                auto size = read_node();
+                auto* node = new ::HIR::ExprNode_ArraySized(mv$(sp), mv$(val), mv$(size));
+                rv.reset(node);
+                node->m_size_val = read_u64();
+                } break;
+
+            case NODE_Closure: {
+                auto idx = read_u64();
+                if( idx >= m_closure_storage.size() || !m_closure_storage[idx] )
+                    throw CacheReadFailure {};
+                auto node = mv$(m_closure_storage[idx]);
+                node->m_span = mv$(sp);
+                auto arg_count = read_count();
+                for(size_t i = 0; i < arg_count; i ++)
+                {
+                    auto pat = read_pattern();
+                    node->m_args.push_back( ::std::make_pair( mv$(pat), read_type() ) );
+                }
+                node->m_return = read_type();
+                node->m_code = read_node();
+                node->m_class = read_tag< ::HIR::ExprNode_Closure::Class>( static_cast<unsigned int>(::HIR::ExprNode_Closure::Class::Once) );
+                node->m_is_move = read_bool();
+                auto capture_count = read_count();
+                for(size_t i = 0; i < capture_count; i ++)
+                    node->m_var_captures.push_back( static_cast<unsigned int>(read_u64()) );
+                node->m_obj_path = read_generic_path();
+                rv = mv$(node);
+                } break;
+            }
+            rv->m_res_type = mv$(res_type);
+            rv->m_usage = usage;
+            return rv;
+        }
+    };
+
+    // ----------------------------------------------------------------
+    // Crate signature hash
+    // ----------------------------------------------------------------
+    /// Writes out everything about the crate's items except function bodies
+    class InterfaceWriter:
+        public ::HIR::Visitor
+    {
+        Writer& m_w;
+    public:
+        InterfaceWriter(Writer& w):
+            m_w(w)
+        {}
+
+        void visit_crate(::HIR::Crate& crate) override {
+            // Language items (sorted, to not depend on hash map ordering)
+            ::std::map< ::std::string, const ::HIR::SimplePath*>   lang_items;
+            for(const auto& li : crate.m_lang_items)
+                lang_items.insert( ::std::make_pair(li.first, &li.second) );
+            m_w.write_count(lang_items.size());
+            for(const auto& li : lang_items) {
+                m_w.write_string(li.first);
+                m_w.write_simple_path(*li.second);
+            }
+            ::HIR::Visitor::visit_crate(crate);
+        }
+        void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override {
+            m_w.write_u8('m');
+            m_w.write_simple_path(p.get_simple_path());
+            m_w.write_count(mod.m_traits.size());
+            for(const auto& t : mod.m_traits)
+                m_w.write_simple_path(t);
+            // Imports and constructors aren't passed to the visitor
+            for(const auto& ent : mod.m_mod_items)
+            {
+                TU_IFLET(::HIR::TypeItem, ent.second->ent, Import, e,
+                    m_w.write_string(ent.first);
+                    m_w.write_simple_path(e);
+                )
+            }
+            for(const auto& ent : mod.m_value_items)
+            {
+                m_w.write_string(ent.first);
+                m_w.write_u8( static_cast<uint8_t>(ent.second->ent.tag()) );
+                TU_MATCH_DEF(::HIR::ValueItem, (ent.second->ent), (e),
+                (
+                    ),
+                (Import,
+                    m_w.write_simple_path(e);
+                    ),
+                (StructConstant,
+                    m_w.write_simple_path(e.ty);
+                    ),
+                (StructConstructor,
+                    m_w.write_simple_path(e.ty);
+                    )
+                )
+            }
+            ::HIR::Visitor::visit_module(p, mod);
+        }
+
+        void visit_type_impl(::HIR::TypeImpl& impl) override {
+            m_w.write_u8('I');
+            m_w.write_generic_params(impl.m_params);
+            m_w.write_type(impl.m_type);
+            m_w.write_simple_path(impl.m_src_module);
+            m_w.write_count(impl.m_methods.size());
+            for(auto& m : impl.m_methods) {
+                m_w.write_string(m.first);
+                m_w.write_bool(m.second.is_pub);
+                m_w.write_bool(m.second.is_specialisable);
+                write_function_sig(m.second.data);
+            }
+        }
+        void visit_trait_impl(const ::HIR::SimplePath& trait_path, ::HIR::TraitImpl& impl) override {
+            m_w.write_u8('T');
+            m_w.write_simple_path(trait_path);
+            m_w.write_generic_params(impl.m_params);
+            m_w.write_path_params(impl.m_trait_args);
+            m_w.write_type(impl.m_type);
+            m_w.write_simple_path(impl.m_src_module);
+            m_w.write_count(impl.m_methods.size());
+            for(auto& m : impl.m_methods) {
+                m_w.write_string(m.first);
+                m_w.write_bool(m.second.is_specialisable);
+                write_function_sig(m.second.data);
+            }
+            m_w.write_count(impl.m_constants.size());
+            for(auto& c : impl.m_constants) {
+                m_w.write_string(c.first);
+                m_w.write_bool(c.second.is_specialisable);
+                write_opt_body(c.second.data);
+            }
+            m_w.write_count(impl.m_types.size());
+            for(auto& t : impl.m_types) {
+                m_w.write_string(t.first);
+                m_w.write_bool(t.second.is_specialisable);
+                m_w.write_type(t.second.data);
+            }
+        }
+        void visit_marker_impl(const ::HIR::SimplePath& trait_path, ::HIR::MarkerImpl& impl) override {
+            m_w.write_u8('M');
+            m_w.write_simple_path(trait_path);
+            m_w.write_generic_params(impl.m_params);
+            m_w.write_path_params(impl.m_trait_args);
+            m_w.write_bool(impl.is_positive);
+            m_w.write_type(impl.m_type);
+            m_w.write_simple_path(impl.m_src_module);
+        }
+
+        void visit_type_alias(::HIR::ItemPath p, ::HIR::TypeAlias& item) override {
+            m_w.write_u8('a');
+            m_w.write_simple_path(p.get_simple_path());
+            m_w.write_generic_params(item.m_params);
+            m_w.write_type(item.m_type);
+        }
+        void visit_trait(::HIR::ItemPath p, ::HIR::Trait& item) override {
+            m_w.write_u8('t');
+            m_w.write_simple_path(p.get_simple_path());
+            m_w.write_generic_params(item.m_params);
+            m_w.write_string(item.m_lifetime);
+            m_w.write_count(item.m_parent_traits.size());
+            for(const auto& pt : item.m_parent_traits)
+                m_w.write_trait_path(pt);
+            m_w.write_bool(item.m_is_marker);
+            m_w.write_count(item.m_types.size());
+            for(const auto& t : item.m_types) {
+                m_w.write_string(t.first);
+                m_w.write_bool(t.second.is_sized);
+                m_w.write_string(t.second.m_lifetime_bound);
+                m_w.write_count(t.second.m_trait_bounds.size());
+                for(const auto& b : t.second.m_trait_bounds)
+                    m_w.write_trait_path(b);
+                m_w.write_type(t.second.m_default);
+            }
+            m_w.write_count(item.m_values.size());
+            for(auto& v : item.m_values) {
+                m_w.write_string(v.first);
+                m_w.write_u8( static_cast<uint8_t>(v.second.tag()) );
+                TU_MATCH(::HIR::TraitValueItem, (v.second), (e),
+                (None,
+                    ),
+                (Constant,
+                    write_constant(e);
+                    ),
+                (Static,
+                    write_static(e);
+                    ),
+                (Function,
+                    write_function_sig(e);
+                    )
+                )
+            }
+        }
+        void visit_struct(::HIR::ItemPath p, ::HIR::Struct& item) override {
+            m_w.write_u8('s');
+            m_w.write_simple_path(p.get_simple_path());
+            m_w.write_generic_params(item.m_params);
+            m_w.write_u8( static_cast<uint8_t>(item.m_repr) );
+            m_w.write_u8( static_cast<uint8_t>(item.m_data.tag()) );
+            TU_MATCH(::HIR::Struct::Data, (item.m_data), (e),
+            (Unit,
+                ),
+            (Tuple,
+                write_tuple_fields(e);
+                ),
+            (Named,
+                write_struct_fields(e);
+                )
+            )
+        }
+        void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
+            m_w.write_u8('e');
+            m_w.write_simple_path(p.get_simple_path());
+            m_w.write_generic_params(item.m_params);
+            m_w.write_u8( static_cast<uint8_t>(item.m_repr) );
+            m_w.write_count(item.m_variants.size());
+            for(auto& var : item.m_variants)
+            {
+                m_w.write_string(var.first);
+                m_w.write_u8( static_cast<uint8_t>(var.second.tag()) );
+                TU_MATCH(::HIR::Enum::Variant, (var.second), (e),
+                (Unit,
+                    ),
+                (Value,
+                    write_opt_body(e);
+                    ),
+                (Tuple,
+                    write_tuple_fields(e);
+                    ),
+                (Struct,
+                    write_struct_fields(e);
+                    )
+                )
+            }
+        }
+        void visit_function(::HIR::ItemPath p, ::HIR::Function& item) override {
+            m_w.write_u8('f');
+            m_w.write_simple_path(p.get_simple_path());
+            write_function_sig(item);
+        }
+        void visit_static(::HIR::ItemPath p, ::HIR::Static& item) override {
+            m_w.write_u8('S');
+            m_w.write_simple_path(p.get_simple_path());
+            write_static(item);
+        }
+        void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
+            m_w.write_u8('c');
+            m_w.write_simple_path(p.get_simple_path());
+            write_constant(item);
+        }
+
+    private:
+        void write_opt_body(::HIR::ExprPtr& e) {
+            m_w.write_bool( static_cast<bool>(e) );
+            if( e )
+                m_w.write_body(e);
+        }
+        void write_function_sig(const ::HIR::Function& fcn) {
+            m_w.write_string(fcn.m_abi);
+            m_w.write_bool(fcn.m_unsafe);
+            m_w.write_bool(fcn.m_const);
+            m_w.write_generic_params(fcn.m_params);
+            m_w.write_count(fcn.m_args.size());
+            for(const auto& arg : fcn.m_args) {
+                m_w.write_pattern(arg.first);
+                m_w.write_type(arg.second);
+            }
+            m_w.write_type(fcn.m_return);
+        }
+        void write_static(::HIR::Static& item) {
+            m_w.write_bool(item.m_is_mut);
+            m_w.write_type(item.m_type);
+            write_opt_body(item.m_value);
+        }
+        void write_constant(::HIR::Constant& item) {
+            m_w.write_generic_params(item.m_params);
+            m_w.write_type(item.m_type);
+            write_opt_body(item.m_value);
+        }
+        void write_tuple_fields(const ::HIR::t_tuple_fields& fields) {
+            m_w.write_count(fields.size());
+            for(const auto& f : fields) {
+                m_w.write_bool(f.is_public);
+                m_w.write_type(f.ent);
+            }
+        }
+        void write_struct_fields(const ::HIR::t_struct_fields& fields) {
+            m_w.write_count(fields.size());
+            for(const auto& f : fields) {
+                m_w.write_string(f.first);
+                m_w.write_bool(f.second.is_public);
+                m_w.write_type(f.second.ent);
+            }
+        }
+    };
+}
+
+ExprCache::ExprCache(::HIR::Crate& crate, ::std::string path):
+    m_crate(crate),
+    m_path( mv$(path) ),
+    m_crate_hash(0),
+    m_hit_count(0),
+    m_miss_count(0)
+{
+    ::std::string   buf;
+    try
+    {
+        Writer  w { buf, 0, true };
+        InterfaceWriter iw { w };
+        iw.visit_crate(m_crate);
+    }
+    catch(const Uncacheable& e)
+    {
+        // Leave the hash as zero (never matches a written cache)
+        DEBUG("Crate signatures can't be hashed - " << e.reason);
+        return ;
+    }
+    auto h = hash_buffer(buf);
+    m_crate_hash = h.first ^ (h.second << 1) ^ CACHE_VERSION;
+    if( m_crate_hash == 0 )
+        m_crate_hash = 1;
+}
+
+void ExprCache::load()
+{
+    TRACE_FUNCTION_F(m_path);
+    if( m_crate_hash == 0 )
+        return ;
+
+    ::std::string   buf;
+    if( !read_file(m_path, buf) ) {
+        DEBUG("No cache file");
+        return ;
+    }
+
+    try
+    {
+        ByteReader  r { buf };
+        if( r.read_string() != CACHE_MAGIC )
+            throw CacheReadFailure {};
+        if( r.read_u64() != CACHE_VERSION )
+            throw CacheReadFailure {};
+        if( r.read_u64_raw() != m_crate_hash ) {
+            DEBUG("Crate signatures changed, discarding cache");
+            return ;
+        }
+        auto count = r.read_count();
+        for(size_t i = 0; i < count; i ++)
+        {
+            Key key;
+            key.first = r.read_u64_raw();
+            key.second = r.read_u64_raw();
+            m_loaded.insert( ::std::make_pair(key, r.read_string()) );
+        }
+        if( !r.at_end() )
+            throw CacheReadFailure {};
+    }
+    catch(const CacheReadFailure& )
+    {
+        DEBUG("Malformed cache file, ignoring");
+        m_loaded.clear();
+    }
+    DEBUG(m_loaded.size() << " entries loaded");
+}
+
+void ExprCache::save() const
+{
+    TRACE_FUNCTION_F(m_path);
+    DEBUG(m_hit_count << " hits, " << m_miss_count << " misses");
+    if( m_crate_hash == 0 )
+        return ;
+
+    ::std::string   buf;
+    ByteWriter  w { buf };
+    w.write_string(CACHE_MAGIC);
+    w.write_u64(CACHE_VERSION);
+    w.write_u64_raw(m_crate_hash);
+    w.write_count(m_current.size());
+    for(const auto& ent : m_current)
+    {
+        w.write_u64_raw(ent.first.first);
+        w.write_u64_raw(ent.first.second);
+        w.write_string(ent.second);
+    }
+
+    ::std::ofstream os(m_path, ::std::ios::binary);
+    os.write(buf.data(), buf.size());
+    if( !os.good() ) {
+        WARNING(Span(), W0000, "Unable to write typecheck cache to " << m_path);
+    }
+}
+
+bool ExprCache::make_key(const ::typeck::ModuleState& ms, const t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr, Key& out_key) const
+{
+    if( m_crate_hash == 0 )
+        return false;
+
+    ::std::string   buf;
+    try
+    {
+        Writer  w { buf, expr->m_span.start_line };
+        w.write_bool(ms.m_impl_generics != nullptr);
+        if( ms.m_impl_generics )
+            w.write_generic_params(*ms.m_impl_generics);
+        w.write_bool(ms.m_item_generics != nullptr);
+        if( ms.m_item_generics )
+            w.write_generic_params(*ms.m_item_generics);
+        w.write_count(ms.m_traits.size());
+        for(const auto& t : ms.m_traits)
+        {
+            w.write_bool(t.first != nullptr);
+            if( t.first )
+                w.write_simple_path(*t.first);
+        }
+        w.write_count(args.size());
+        for(const auto& arg : args)
+        {
+            w.write_pattern(arg.first);
+            w.write_type(arg.second);
+        }
+        w.write_type(result_type);
+        w.write_body(expr);
+    }
+    catch(const Uncacheable& e)
+    {
+        DEBUG("Uncacheable - " << e.reason);
+        return false;
+    }
+    out_key = hash_buffer(buf);
+    return true;
+}
+
+bool ExprCache::lookup(const Key& key, t_args& args, ::HIR::ExprPtr& expr)
+{
+    // - Identical bodies (with the same context) can occur more than once in a crate
+    const auto* map = &m_loaded;
+    auto it = m_loaded.find(key);
+    if( it == m_loaded.end() ) {
+        map = &m_current;
+        it = m_current.find(key);
+        if( it == m_current.end() ) {
+            m_miss_count ++;
+            return false;
+        }
+    }
+
+    t_args  new_args;
+    ::HIR::ExprPtr  new_expr;
+    try
+    {
+        Reader  r { m_crate, it->second, expr->m_span.start_line };
+        auto arg_count = r.read_count();
+        if( arg_count != args.size() )
+            throw CacheReadFailure {};
+        for(size_t i = 0; i < arg_count; i ++)
+        {
+            auto pat = r.read_pattern();
+            new_args.push_back( ::std::make_pair( mv$(pat), r.read_type() ) );
+        }
+        r.read_body(new_expr);
+        r.finish();
+    }
+    catch(const CacheReadFailure& )
+    {
+        DEBUG("Malformed cache entry");
+        m_miss_count ++;
+        return false;
+    }
+    DEBUG("Cache hit");
+    m_hit_count ++;
+
+    for(size_t i = 0; i < args.size(); i ++)
+        args[i].first = mv$(new_args[i].first);
+    expr = mv$(new_expr);
+
+    if( map == &m_loaded ) {
+        m_current.insert( ::std::make_pair(key, mv$(it->second)) );
+        m_loaded.erase(it);
+    }
+    return true;
+}
+
+void ExprCache::store(const Key& key, t_args& args, ::HIR::ExprPtr& expr)
+{
+    ::std::string   buf;
+    try
+    {
+        Writer  w { buf, expr->m_span.start_line };
+        w.write_count(args.size());
+        for(const auto& arg : args)
+        {
+            w.write_pattern(arg.first);
+            w.write_type(arg.second);
+        }
+        w.write_body(expr);
+    }
+    catch(const Uncacheable& e)
+    {
+        DEBUG("Uncacheable result - " << e.reason);
+        return ;
+    }
+    m_current[key] = mv$(buf);
+}
@@ -0,0 +1,59 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * hir_typeck/expr_cache.hpp
+ * - On-disk cache of typechecked expression trees
+ */
+#pragma once
+
+#include <hir/hir.hpp>
+#include <map>
+#include <string>
+#include <cstdint>
+
+namespace typeck {
+    struct ModuleState;
+}
+
+/// Cache of typecheck results, persisted between runs
+///
+/// Entries are keyed on a hash of the pre-typecheck body and the context it is checked in (generics, argument and
+/// return types, in-scope traits). The cache file is tagged with a hash of every item signature in the crate, if
+/// that changes then all entries are discarded.
+class ExprCache
+{
+public:
+    typedef ::std::vector< ::std::pair< ::HIR::Pattern, ::HIR::TypeRef> >   t_args;
+    typedef ::std::pair<uint64_t, uint64_t> Key;
+
+private:
+    ::HIR::Crate&   m_crate;
+    ::std::string   m_path;
+
+    /// Hash of the crate's item signatures (excluding function bodies)
+    uint64_t    m_crate_hash;
+    /// Entries read from the cache file
+    ::std::map<Key, ::std::string>  m_loaded;
+    /// Entries used or created this run (only these are written back)
+    ::std::map<Key, ::std::string>  m_current;
+
+    unsigned int    m_hit_count;
+    unsigned int    m_miss_count;
+
+public:
+    ExprCache(::HIR::Crate& crate, ::std::string path);
+
+    /// Read the cache file (discarding its contents if the crate's signatures have changed)
+    void load();
+    /// Write all entries used/created this run back to the cache file
+    void save() const;
+
+    /// Calculate the lookup key for a body, returns false if the body can't be cached
+    bool make_key(const ::typeck::ModuleState& ms, const t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr, Key& out_key) const;
+    /// Replace `args` and `expr` with the cached result of typechecking them
+    bool lookup(const Key& key, t_args& args, ::HIR::ExprPtr& expr);
+    /// Save the result of typechecking a body
+    void store(const Key& key, t_args& args, ::HIR::ExprPtr& expr);
+};
+
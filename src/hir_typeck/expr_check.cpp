@@ -10,6 +10,7 @@
 #include <hir_typeck/static.hpp>
 #include "main_bindings.hpp"
 #include <algorithm>
+#include <thread_pool.hpp>
 
 namespace {
     typedef ::std::vector< ::std::pair< ::HIR::Pattern, ::HIR::TypeRef> >   t_args;
@@ -19,7 +20,7 @@ namespace {
     // Iterates the HIR expression tree and extracts type "equations"
     // -----------------------------------------------------------------------
     class ExprVisitor_Validate:
-        public ::HIR::ExprVisitor
+        public ::HIR::ExprVisitorT<ExprVisitor_Validate>
     {
         const StaticTraitResolve&  m_resolve;
         //const t_args&   m_args;
@@ -36,69 +37,69 @@ namespace {
         
         void visit_root(::HIR::ExprNode& node)
         {
-            node.visit(*this);
+            ::HIR::visit_expr_node(node, *this);
             check_types_equal(node.span(), ret_type, node.m_res_type);
         }
         
-        void visit(::HIR::ExprNode_Block& node) override
+        void visit(::HIR::ExprNode_Block& node)
         {
             TRACE_FUNCTION_F(&node << " { ... }");
             for(auto& n : node.m_nodes)
             {
-                n->visit(*this);
+                this->visit_node_ptr(n);
             }
             if( node.m_nodes.size() > 0 )
             {
                 check_types_equal(node.span(), node.m_res_type, node.m_nodes.back()->m_res_type);
             }
         }
-        void visit(::HIR::ExprNode_Return& node) override
+        void visit(::HIR::ExprNode_Return& node)
         {
             TRACE_FUNCTION_F(&node << " return ...");
             // Check against return type
             const auto& ret_ty = ( this->closure_ret_types.size() > 0 ? *this->closure_ret_types.back() : this->ret_type );
             check_types_equal(ret_ty, node.m_value);
-            node.m_value->visit(*this);
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Loop& node) override
+        void visit(::HIR::ExprNode_Loop& node)
         {
             TRACE_FUNCTION_F(&node << " loop { ... }");
-            node.m_code->visit(*this);
+            this->visit_node_ptr(node.m_code);
         }
-        void visit(::HIR::ExprNode_LoopControl& node) override
+        void visit(::HIR::ExprNode_LoopControl& node)
         {
             //TRACE_FUNCTION_F(&node << " " << (node.m_continue ? "continue" : "break") << " '" << node.m_label);
         }
-        void visit(::HIR::ExprNode_Let& node) override
+        void visit(::HIR::ExprNode_Let& node)
         {
             TRACE_FUNCTION_F(&node << " let " << node.m_pattern << ": " << node.m_type);
             if(node.m_value)
             {
                 check_types_equal(node.span(), node.m_type, node.m_value->m_res_type);
-                node.m_value->visit(*this);
+                this->visit_node_ptr(node.m_value);
             }
         }
-        void visit(::HIR::ExprNode_Match& node) override
+        void visit(::HIR::ExprNode_Match& node)
         {
             TRACE_FUNCTION_F(&node << " match ...");
-            node.m_value->visit(*this);
+            this->visit_node_ptr(node.m_value);
             for(auto& arm : node.m_arms)
             {
                 check_types_equal(node.span(), node.m_res_type, arm.m_code->m_res_type);
-                arm.m_code->visit( *this );
+                this->visit_node_ptr(arm.m_code);
             }
         }
-        void visit(::HIR::ExprNode_If& node) override
+        void visit(::HIR::ExprNode_If& node)
         {
             TRACE_FUNCTION_F(&node << " if ... { ... } else { ... }");
-            node.m_cond->visit( *this );
+            this->visit_node_ptr(node.m_cond);
             check_types_equal(node.span(), node.m_res_type, node.m_true->m_res_type);
             if( node.m_false )
             {
                 check_types_equal(node.span(), node.m_res_type, node.m_false->m_res_type);
             }
         }
-        void visit(::HIR::ExprNode_Assign& node) override
+        void visit(::HIR::ExprNode_Assign& node)
         {
             TRACE_FUNCTION_F(&node << "... ?= ...");
             
@@ -129,10 +130,10 @@ namespace {
                 check_associated_type(node.span(),  ::HIR::TypeRef(),  trait_path, ::make_vec1(node.m_value->m_res_type.clone()), node.m_slot->m_res_type,  "");
             }
             
-            node.m_slot->visit( *this );
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_slot);
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_BinOp& node) override
+        void visit(::HIR::ExprNode_BinOp& node)
         {
             TRACE_FUNCTION_F(&node << "... "<<::HIR::ExprNode_BinOp::opname(node.m_op)<<" ...");
             
@@ -200,11 +201,11 @@ namespace {
                 break; }
             }
             
-            node.m_left ->visit( *this );
-            node.m_right->visit( *this );
+            this->visit_node_ptr(node.m_left);
+            this->visit_node_ptr(node.m_right);
         }
         
-        void visit(::HIR::ExprNode_UniOp& node) override
+        void visit(::HIR::ExprNode_UniOp& node)
         {
             TRACE_FUNCTION_F(&node << " " << ::HIR::ExprNode_UniOp::opname(node.m_op) << "...");
             switch(node.m_op)
@@ -216,15 +217,15 @@ namespace {
                 check_associated_type(node.span(), node.m_res_type,  this->get_lang_item_path(node.span(), "neg"), {}, node.m_value->m_res_type, "Output");
                 break;
             }
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Borrow& node) override
+        void visit(::HIR::ExprNode_Borrow& node)
         {
             TRACE_FUNCTION_F(&node << " &_ ...");
             check_types_equal(node.span(), node.m_res_type, ::HIR::TypeRef::new_borrow(node.m_type, node.m_value->m_res_type.clone()));
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Index& node) override
+        void visit(::HIR::ExprNode_Index& node)
         {
             TRACE_FUNCTION_F(&node << " ... [ ... ]");
             check_associated_type(node.span(),
@@ -232,11 +233,11 @@ namespace {
                 this->get_lang_item_path(node.span(), "index"), ::make_vec1(node.m_index->m_res_type.clone()), node.m_value->m_res_type, "Target"
                 );
             
-            node.m_value->visit( *this );
-            node.m_index->visit( *this );
+            this->visit_node_ptr(node.m_value);
+            this->visit_node_ptr(node.m_index);
         }
         
-        void visit(::HIR::ExprNode_Cast& node) override
+        void visit(::HIR::ExprNode_Cast& node)
         {
             TRACE_FUNCTION_F(&node << " ... as " << node.m_res_type);
             const Span& sp = node.span();
@@ -276,9 +277,9 @@ namespace {
                 )
             )
             
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Unsize& node) override
+        void visit(::HIR::ExprNode_Unsize& node)
         {
             TRACE_FUNCTION_F(&node << " ... : " << node.m_res_type);
             const Span& sp = node.span();
@@ -298,9 +299,9 @@ namespace {
                 )
             )
             
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Deref& node) override
+        void visit(::HIR::ExprNode_Deref& node)
         {
             TRACE_FUNCTION_F(&node << " *...");
             check_associated_type(node.span(),
@@ -308,9 +309,9 @@ namespace {
                 this->get_lang_item_path(node.span(), "deref"), {}, node.m_value->m_res_type, "Target"
                 );
 
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_TupleVariant& node) override
+        void visit(::HIR::ExprNode_TupleVariant& node)
         {
             TRACE_FUNCTION_F(&node << " " << node.m_path << "(...,) [" << (node.m_is_struct ? "struct" : "enum") << "]");
             const auto& sp = node.span();
@@ -355,10 +356,10 @@ namespace {
             }
             
             for( auto& val : node.m_args ) {
-                val->visit( *this );
+                this->visit_node_ptr(val);
             }
         }
-        void visit(::HIR::ExprNode_StructLiteral& node) override
+        void visit(::HIR::ExprNode_StructLiteral& node)
         {
             TRACE_FUNCTION_F(&node << " " << node.m_path << "{...} [" << (node.m_is_struct ? "struct" : "enum") << "]");
             const auto& sp = node.span();
@@ -407,13 +408,13 @@ namespace {
             }
             
             for( auto& val : node.m_values ) {
-                val.second->visit( *this );
+                this->visit_node_ptr(val.second);
             }
             if( node.m_base_value ) {
-                node.m_base_value->visit( *this );
+                this->visit_node_ptr(node.m_base_value);
             }
         }
-        void visit(::HIR::ExprNode_UnitVariant& node) override
+        void visit(::HIR::ExprNode_UnitVariant& node)
         {
             TRACE_FUNCTION_F(&node << " " << node.m_path << " [" << (node.m_is_struct ? "struct" : "enum") << "]");
             const auto& sp = node.span();
@@ -436,13 +437,13 @@ namespace {
             )
         }
 
-        void visit(::HIR::ExprNode_CallPath& node) override
+        void visit(::HIR::ExprNode_CallPath& node)
         {
             const auto& sp = node.span();
             TRACE_FUNCTION_F(&node << " " << node.m_path << "(..., )");
             
             for( auto& val : node.m_args ) {
-                val->visit( *this );
+                this->visit_node_ptr(val);
             }
             
             // Do function resolution again, this time with concrete types.
@@ -651,7 +652,7 @@ namespace {
                 )
             }
         }
-        void visit(::HIR::ExprNode_CallValue& node) override
+        void visit(::HIR::ExprNode_CallValue& node)
         {
             TRACE_FUNCTION_F(&node << " (...)(..., )");
             // TODO: Don't use m_arg_types (do full resolution again)
@@ -664,12 +665,12 @@ namespace {
             
             // Don't bother checking for a FnOnce impl, if the cache is populated it was found
             
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
             for( auto& val : node.m_args ) {
-                val->visit( *this );
+                this->visit_node_ptr(val);
             }
         }
-        void visit(::HIR::ExprNode_CallMethod& node) override
+        void visit(::HIR::ExprNode_CallMethod& node)
         {
             TRACE_FUNCTION_F(&node << " (...)." << node.m_method << "(...,) - " << node.m_method_path);
             // TODO: Don't use m_cache
@@ -682,13 +683,13 @@ namespace {
             }
             check_types_equal(node.span(), node.m_res_type, node.m_cache.m_arg_types.back());
             
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
             for( auto& val : node.m_args ) {
-                val->visit( *this );
+                this->visit_node_ptr(val);
             }
         }
         
-        void visit(::HIR::ExprNode_Field& node) override
+        void visit(::HIR::ExprNode_Field& node)
         {
             TRACE_FUNCTION_F(&node << " (...)." << node.m_field);
             const auto& sp = node.span();
@@ -713,9 +714,9 @@ namespace {
                 // TODO: Triple-check result, but that probably isn't needed
             }
             
-            node.m_value->visit( *this );
+            this->visit_node_ptr(node.m_value);
         }
-        void visit(::HIR::ExprNode_Tuple& node) override
+        void visit(::HIR::ExprNode_Tuple& node)
         {
             TRACE_FUNCTION_F(&node << " (...,)");
             const auto& tys = node.m_res_type.m_data.as_Tuple();
@@ -727,10 +728,10 @@ namespace {
             }
             
             for( auto& val : node.m_vals ) {
-                val->visit( *this );
+                this->visit_node_ptr(val);
             }
         }
-        void visit(::HIR::ExprNode_ArrayList& node) override
+        void visit(::HIR::ExprNode_ArrayList& node)
         {
             TRACE_FUNCTION_F(&node << " [...,]");
             // Cleanly equate into array (with coercions)
@@ -740,10 +741,10 @@ namespace {
             }
             
             for( auto& val : node.m_vals ) {
-                val->visit( *this );
+                this->visit_node_ptr(val);
             }
         }
-        void visit(::HIR::ExprNode_ArraySized& node) override
+        void visit(::HIR::ExprNode_ArraySized& node)
         {
             TRACE_FUNCTION_F(&node << " [...; "<<node.m_size_val<<"]");
             
@@ -751,15 +752,15 @@ namespace {
             const auto& inner_ty = *node.m_res_type.m_data.as_Array().inner;
             check_types_equal(node.m_val->span(), inner_ty, node.m_val->m_res_type);
             
-            node.m_val->visit( *this );
-            node.m_size->visit( *this );
+            this->visit_node_ptr(node.m_val);
+            this->visit_node_ptr(node.m_size);
         }
         
-        void visit(::HIR::ExprNode_Literal& node) override
+        void visit(::HIR::ExprNode_Literal& node)
         {
             // No validation needed
         }
-        void visit(::HIR::ExprNode_PathValue& node) override
+        void visit(::HIR::ExprNode_PathValue& node)
         {
             TRACE_FUNCTION_F(&node << " " << node.m_path);
             const auto& sp = node.span();
@@ -811,12 +812,12 @@ namespace {
             )
         }
         
-        void visit(::HIR::ExprNode_Variable& node) override
+        void visit(::HIR::ExprNode_Variable& node)
         {
             // TODO: Check against variable slot? Nah.
         }
         
-        void visit(::HIR::ExprNode_Closure& node) override
+        void visit(::HIR::ExprNode_Closure& node)
         {
             TRACE_FUNCTION_F(&node << " |...| ...");
             
@@ -824,7 +825,7 @@ namespace {
             {
                 check_types_equal(node.m_code->span(), node.m_return, node.m_code->m_res_type);
                 this->closure_ret_types.push_back( &node.m_return );
-                node.m_code->visit( *this );
+                this->visit_node_ptr(node.m_code);
                 this->closure_ret_types.pop_back( );
             }
         }
@@ -864,12 +865,45 @@ namespace {
     class OuterVisitor:
         public ::HIR::Visitor
     {
-        StaticTraitResolve  m_resolve;
+        /// Expression body to validate, with the generic scope and expected types
+        struct Body {
+            ::HIR::ExprPtr* exp;
+            ::HIR::GenericParams*   impl_generics;
+            ::HIR::GenericParams*   item_generics;
+            const t_args*   args;
+            const ::HIR::TypeRef*   ret_type;
+        };
+        
+        const ::HIR::Crate& m_crate;
+        ::HIR::GenericParams*   m_impl_generics;
+        ::HIR::GenericParams*   m_item_generics;
+        ::std::vector<Body> m_bodies;
+        TypeEqualityCache   m_equality_cache;
+        
+        const t_args    m_empty_args;
+        const ::HIR::TypeRef    m_usize_type;
+        // TODO: Use a different type depding on repr()
+        const ::HIR::TypeRef    m_enum_type;
     public:
         OuterVisitor(const ::HIR::Crate& crate):
-            m_resolve(crate)
+            m_crate(crate),
+            m_impl_generics(nullptr),
+            m_item_generics(nullptr),
+            m_usize_type( ::HIR::CoreType::Usize ),
+            m_enum_type( ::HIR::CoreType::Isize )
         {}
         
+        void visit_crate(::HIR::Crate& crate) override
+        {
+            ::HIR::Visitor::visit_crate(crate);
+            
+            parallel_for(m_bodies.size(), [&](unsigned int i) {
+                const auto& body = m_bodies[i];
+                Typecheck_Expressions_ValidateOne(m_crate, body.impl_generics, body.item_generics, *body.args, *body.ret_type, *body.exp, &m_equality_cache);
+                });
+            m_bodies.clear();
+        }
+        
         // NOTE: This is left here to ensure that any expressions that aren't handled by higher code cause a failure
         void visit_expr(::HIR::ExprPtr& exp) override {
             BUG(Span(), "visit_expr hit in OuterVisitor");
@@ -880,10 +914,8 @@ namespace {
             TU_IFLET(::HIR::TypeRef::Data, ty.m_data, Array, e,
                 this->visit_type( *e.inner );
                 DEBUG("Array size " << ty);
-                t_args  tmp;
                 if( e.size ) {
-                    ExprVisitor_Validate    ev(m_resolve, {}, ::HIR::TypeRef(::HIR::CoreType::Usize));
-                    ev.visit_root( *e.size );
+                    m_bodies.push_back( Body { &e.size, m_impl_generics, m_item_generics, &m_empty_args, &m_usize_type } );
                 }
             )
             else {
@@ -894,73 +926,75 @@ namespace {
         // Code-containing items
         // ------
         void visit_function(::HIR::ItemPath p, ::HIR::Function& item) override {
-            auto _ = this->m_resolve.set_item_generics(item.m_params);
+            assert( !m_item_generics );
+            m_item_generics = &item.m_params;
             if( item.m_code )
             {
                 DEBUG("Function code " << p);
-                ExprVisitor_Validate    ev(m_resolve, item.m_args, item.m_return);
-                ev.visit_root( *item.m_code );
+                m_bodies.push_back( Body { &item.m_code, m_impl_generics, m_item_generics, &item.m_args, &item.m_return } );
             }
             else
             {
                 DEBUG("Function code " << p << " (none)");
             }
+            m_item_generics = nullptr;
         }
         void visit_static(::HIR::ItemPath p, ::HIR::Static& item) override {
             if( item.m_value )
             {
-                t_args  tmp;
-                ExprVisitor_Validate    ev(m_resolve, tmp, item.m_type);
-                ev.visit_root(*item.m_value);
+                m_bodies.push_back( Body { &item.m_value, m_impl_generics, m_item_generics, &m_empty_args, &item.m_type } );
             }
         }
         void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
             if( item.m_value )
             {
-                t_args  tmp;
-                ExprVisitor_Validate    ev(m_resolve, tmp, item.m_type);
-                ev.visit_root(*item.m_value);
+                m_bodies.push_back( Body { &item.m_value, m_impl_generics, m_item_generics, &m_empty_args, &item.m_type } );
             }
         }
         void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
             //auto _ = this->m_ms.set_item_generics(item.m_params);
-            // TODO: Use a different type depding on repr()
-            auto enum_type = ::HIR::TypeRef(::HIR::CoreType::Isize);
-            
             for(auto& var : item.m_variants)
             {
                 TU_IFLET(::HIR::Enum::Variant, var.second, Value, e,
                     DEBUG("Enum value " << p << " - " << var.first);
                     
-                    t_args  tmp;
-                    ExprVisitor_Validate    ev(m_resolve, tmp, enum_type);
-                    ev.visit_root(*e);
+                    m_bodies.push_back( Body { &e, m_impl_generics, m_item_generics, &m_empty_args, &m_enum_type } );
                 )
             }
         }
         
         void visit_trait(::HIR::ItemPath p, ::HIR::Trait& item) override
         {
-            auto _ = this->m_resolve.set_impl_generics(item.m_params);
+            assert( !m_impl_generics );
+            m_impl_generics = &item.m_params;
             ::HIR::Visitor::visit_trait(p, item);
+            m_impl_generics = nullptr;
         }
         void visit_type_impl(::HIR::TypeImpl& impl) override
         {
             TRACE_FUNCTION_F("impl " << impl.m_type);
-            auto _ = this->m_resolve.set_impl_generics(impl.m_params);
-            
+            assert( !m_impl_generics );
+            m_impl_generics = &impl.m_params;
             ::HIR::Visitor::visit_type_impl(impl);
+            m_impl_generics = nullptr;
         }
         void visit_trait_impl(const ::HIR::SimplePath& trait_path, ::HIR::TraitImpl& impl) override
         {
             TRACE_FUNCTION_F("impl" << impl.m_params.fmt_args() << " " << trait_path << " for " << impl.m_type);
-            auto _ = this->m_resolve.set_impl_generics(impl.m_params);
-            
+            assert( !m_impl_generics );
+            m_impl_generics = &impl.m_params;
             ::HIR::Visitor::visit_trait_impl(trait_path, impl);
+            m_impl_generics = nullptr;
         }
     };
 }
 
+void Typecheck_Expressions_ValidateOne(const ::HIR::Crate& crate, ::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, const t_args& args, const ::HIR::TypeRef& ret_type, ::HIR::ExprPtr& exp, TypeEqualityCache* equality_cache)
+{
+    StaticTraitResolve  resolve { crate, impl_generics, item_generics, equality_cache };
+    ExprVisitor_Validate    ev(resolve, args, ret_type);
+    ev.visit_root( *exp );
+}
 void Typecheck_Expressions_Validate(::HIR::Crate& crate)
 {
     OuterVisitor    ov(crate);
@@ -86,9 +86,9 @@ struct Context
     
     ::std::vector< IVarPossible>    possible_ivar_vals;
     
-    Context(const ::HIR::Crate& crate, const ::HIR::GenericParams* impl_params, const ::HIR::GenericParams* item_params):
+    Context(const ::HIR::Crate& crate, const ::HIR::GenericParams* impl_params, const ::HIR::GenericParams* item_params, MethodCache* method_cache, TypeEqualityCache* equality_cache):
         m_crate(crate),
-        m_resolve(m_ivars, crate, impl_params, item_params)
+        m_resolve(m_ivars, crate, impl_params, item_params, method_cache, equality_cache)
     {
     }
     
@@ -3895,8 +3895,10 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
 {
     TRACE_FUNCTION;
     
+    // NOTE: Nodes inserted by typecheck (derefs, casts, ...) go in the body's existing table
+    ::HIR::ExprNodeTable::Scope node_table { expr.node_table() };
     auto root_ptr = expr.into_unique();
-    Context context { ms.m_crate, ms.m_impl_generics, ms.m_item_generics };
+    Context context { ms.m_crate, ms.m_impl_generics, ms.m_item_generics, ms.m_method_cache, ms.m_equality_cache };
     
     for( auto& arg : args ) {
         context.add_binding( Span(), arg.first, arg.second );
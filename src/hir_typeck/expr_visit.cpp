@@ -4,30 +4,86 @@
 #include <hir/expr.hpp>
 #include <hir/visitor.hpp>
 #include "expr_visit.hpp"
+#include "helpers.hpp"
+#include "main_bindings.hpp"
+#include "expr_cache.hpp"
+#include <hir_expand/main_bindings.hpp>
+#include <mir/main_bindings.hpp>
 
 namespace {
     void Typecheck_Code(const typeck::ModuleState& ms, t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr) {
+        ExprCache::Key  cache_key;
+        bool use_cache = ms.m_expr_cache && ms.m_expr_cache->make_key(ms, args, result_type, expr, cache_key);
+        if( use_cache && ms.m_expr_cache->lookup(cache_key, args, expr) ) {
+            return ;
+        }
+        
         //Typecheck_Code_Simple(ms, args, result_type, expr);
         Typecheck_Code_CS(ms, args, result_type, expr);
+        
+        if( use_cache ) {
+            ms.m_expr_cache->store(cache_key, args, expr);
+        }
     }
     
     class OuterVisitor:
         public ::HIR::Visitor
     {
+        MethodCache m_method_cache;
+        TypeEqualityCache   m_equality_cache;
         ::typeck::ModuleState m_ms;
+        
+        /// If set, function bodies are taken through to MIR as soon as they're typechecked
+        bool    m_pipeline;
+        /// Module containing the current item (for naming closure types)
+        ::HIR::SimplePath   m_cur_mod_path;
+        /// Pipelined body that contained closures
+        /// - The rest of the back half needs the closures' impls, which can't be added to the crate until the visit is complete
+        struct DeferredBody {
+            ::HIR::GenericParams*   impl_generics;
+            ::HIR::GenericParams*   item_generics;
+            ::HIR::Function*    fcn;
+            ClosureExpandOutput closures;
+        };
+        ::std::vector<DeferredBody> m_deferred_bodies;
     public:
-        OuterVisitor(::HIR::Crate& crate):
-            m_ms(crate)
+        OuterVisitor(::HIR::Crate& crate, bool pipeline, ExprCache* expr_cache):
+            m_ms(crate, &m_method_cache, expr_cache, &m_equality_cache),
+            m_pipeline(pipeline)
         {
         }
         
+        void visit_crate(::HIR::Crate& crate) override
+        {
+            ::HIR::Visitor::visit_crate(crate);
+            
+            for(auto& body : m_deferred_bodies)
+            {
+                auto new_impls = HIR_Expand_Closures_Merge(crate, mv$(body.closures));
+                lower_body(body.impl_generics, body.item_generics, body.fcn->m_args, body.fcn->m_return, body.fcn->m_code);
+                // - Code extracted from the closures (already annotated along with the parent body)
+                for(auto* impl : new_impls)
+                {
+                    for(auto& method : impl->m_methods)
+                    {
+                        auto& fcn = method.second.data;
+                        if( fcn.m_code )
+                            lower_body(&impl->m_params, &fcn.m_params, fcn.m_args, fcn.m_return, fcn.m_code);
+                    }
+                }
+            }
+            m_deferred_bodies.clear();
+        }
     
     public:
         void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override
         {
+            auto saved_mod_path = mv$(m_cur_mod_path);
+            m_cur_mod_path = p.get_simple_path();
             m_ms.push_traits(mod);
             ::HIR::Visitor::visit_module(p, mod);
             m_ms.pop_traits(mod);
+            m_cur_mod_path = mv$(saved_mod_path);
         }
         
         // NOTE: This is left here to ensure that any expressions that aren't handled by higher code cause a failure
@@ -47,6 +103,7 @@ namespace {
             auto _ = this->m_ms.set_impl_generics(impl.m_params);
             
             const auto& mod = this->m_ms.m_crate.get_mod_by_path(Span(), impl.m_src_module);
+            m_cur_mod_path = impl.m_src_module.clone();
             m_ms.push_traits(mod);
             ::HIR::Visitor::visit_type_impl(impl);
             m_ms.pop_traits(mod);
@@ -57,6 +114,7 @@ namespace {
             auto _ = this->m_ms.set_impl_generics(impl.m_params);
             
             const auto& mod = this->m_ms.m_crate.get_mod_by_path(Span(), impl.m_src_module);
+            m_cur_mod_path = impl.m_src_module.clone();
             m_ms.push_traits(mod);
             m_ms.m_traits.push_back( ::std::make_pair( &trait_path, &this->m_ms.m_crate.get_trait_by_path(Span(), trait_path) ) );
             ::HIR::Visitor::visit_trait_impl(trait_path, impl);
@@ -97,6 +155,10 @@ namespace {
             {
                 DEBUG("Function code " << p);
                 Typecheck_Code( m_ms, item.m_args, item.m_return, item.m_code );
+                if( m_pipeline )
+                {
+                    this->lower_function_body(p, item);
+                }
             }
             else
             {
@@ -137,11 +199,63 @@ namespace {
                 )
             }
         }
+        
+    private:
+        /// Run the rest of the back half on a just-typechecked function body (while it's still in cache)
+        void lower_function_body(const ::HIR::ItemPath& p, ::HIR::Function& item)
+        {
+            const auto& crate = m_ms.m_crate;
+            HIR_Expand_AnnotateUsage_Expr(crate, m_ms.m_impl_generics, m_ms.m_item_generics, item.m_code, &m_equality_cache);
+            
+            ClosureExpandOutput closures;
+            HIR_Expand_Closures_Expr(crate, m_ms.m_impl_generics, m_ms.m_item_generics, m_cur_mod_path, FMT(p), item.m_code, closures, &m_equality_cache);
+            
+            if( closures.trait_impls.size() > 0 )
+            {
+                m_deferred_bodies.push_back( DeferredBody { m_ms.m_impl_generics, m_ms.m_item_generics, &item, mv$(closures) } );
+            }
+            else
+            {
+                lower_body(m_ms.m_impl_generics, m_ms.m_item_generics, item.m_args, item.m_return, item.m_code);
+            }
+        }
+        void lower_body(::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, const t_args& args, const ::HIR::TypeRef& ret_type, ::HIR::ExprPtr& code)
+        {
+            const auto& crate = m_ms.m_crate;
+            HIR_Expand_UfcsEverything_Expr(crate, code);
+            Typecheck_Expressions_ValidateOne(crate, impl_generics, item_generics, args, ret_type, code, &m_equality_cache);
+            HIR_GenerateMIR_Expr(code, args);
+            // MIR is all that's needed from here on, so release the expression tree (later passes skip empty bodies)
+            code.reset(nullptr);
+        }
     };
 }
 
-void Typecheck_Expressions(::HIR::Crate& crate)
+namespace {
+    void Typecheck_Expressions_Inner(::HIR::Crate& crate, bool pipeline, const ::std::string& cache_file)
+    {
+        ::std::unique_ptr<ExprCache>   cache;
+        if( cache_file != "" )
+        {
+            cache.reset( new ExprCache(crate, cache_file) );
+            cache->load();
+        }
+        
+        OuterVisitor    visitor { crate, pipeline, cache.get() };
+        visitor.visit_crate( crate );
+        
+        if( cache )
+        {
+            cache->save();
+        }
+    }
+}
+
+void Typecheck_Expressions(::HIR::Crate& crate, const ::std::string& cache_file)
+{
+    Typecheck_Expressions_Inner(crate, false, cache_file);
+}
+void Typecheck_Expressions_Pipelined(::HIR::Crate& crate, const ::std::string& cache_file)
 {
-    OuterVisitor    visitor { crate };
-    visitor.visit_crate( crate );
+    Typecheck_Expressions_Inner(crate, true, cache_file);
 }
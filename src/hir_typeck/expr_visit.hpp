@@ -1,4 +1,9 @@
 
+
+class MethodCache;
+class ExprCache;
+class TypeEqualityCache;
+
 namespace typeck {
     struct ModuleState
     {
@@ -9,10 +14,20 @@ namespace typeck {
         
         ::std::vector< ::std::pair< const ::HIR::SimplePath*, const ::HIR::Trait* > >   m_traits;
         
-        ModuleState(::HIR::Crate& crate):
+        /// Crate-wide method lookup cache (optional)
+        MethodCache*    m_method_cache;
+        /// On-disk cache of typechecked bodies (optional)
+        ExprCache*  m_expr_cache;
+        /// Type equalities for each generic scope, shared between bodies (optional)
+        TypeEqualityCache*  m_equality_cache;
+        
+        ModuleState(::HIR::Crate& crate, MethodCache* method_cache=nullptr, ExprCache* expr_cache=nullptr, TypeEqualityCache* equality_cache=nullptr):
             m_crate(crate),
             m_impl_generics(nullptr),
-            m_item_generics(nullptr)
+            m_item_generics(nullptr),
+            m_method_cache(method_cache),
+            m_expr_cache(expr_cache),
+            m_equality_cache(equality_cache)
         {}
     
         template<typename T>
@@ -106,6 +106,86 @@ bool monomorphise_type_needed(const ::HIR::TypeRef& tpl)
     throw "";
 }
 
+bool visit_ty_with(const ::HIR::TypeRef& ty, FunctionRef<bool(const ::HIR::TypeRef&)> callback)
+{
+    if( callback(ty) ) {
+        return true;
+    }
+    
+    auto visit_params = [&](const ::HIR::PathParams& pp) {
+        for(const auto& sty : pp.m_types)
+            if( visit_ty_with(sty, callback) )
+                return true;
+        return false;
+        };
+    TU_MATCH(::HIR::TypeRef::Data, (ty.m_data), (e),
+    (Infer,
+        ),
+    (Diverge,
+        ),
+    (Primitive,
+        ),
+    (Generic,
+        ),
+    (Path,
+        TU_MATCH(::HIR::Path::Data, (e.path.m_data), (pe),
+        (Generic,
+            return visit_params(pe.m_params);
+            ),
+        (UfcsInherent,
+            return visit_ty_with(*pe.type, callback) || visit_params(pe.params);
+            ),
+        (UfcsKnown,
+            return visit_ty_with(*pe.type, callback) || visit_params(pe.trait.m_params) || visit_params(pe.params);
+            ),
+        (UfcsUnknown,
+            return visit_ty_with(*pe.type, callback) || visit_params(pe.params);
+            )
+        )
+        ),
+    (TraitObject,
+        if( visit_params(e.m_trait.m_path.m_params) )
+            return true;
+        for(const auto& assoc : e.m_trait.m_type_bounds)
+            if( visit_ty_with(assoc.second, callback) )
+                return true;
+        for(const auto& marker : e.m_markers)
+            if( visit_params(marker.m_params) )
+                return true;
+        ),
+    (Array,
+        return visit_ty_with(*e.inner, callback);
+        ),
+    (Slice,
+        return visit_ty_with(*e.inner, callback);
+        ),
+    (Tuple,
+        for(const auto& sty : e)
+            if( visit_ty_with(sty, callback) )
+                return true;
+        ),
+    (Borrow,
+        return visit_ty_with(*e.inner, callback);
+        ),
+    (Pointer,
+        return visit_ty_with(*e.inner, callback);
+        ),
+    (Function,
+        for(const auto& sty : e.m_arg_types)
+            if( visit_ty_with(sty, callback) )
+                return true;
+        return visit_ty_with(*e.m_rettype, callback);
+        ),
+    (Closure,
+        for(const auto& sty : e.m_arg_types)
+            if( visit_ty_with(sty, callback) )
+                return true;
+        return visit_ty_with(*e.m_rettype, callback);
+        )
+    )
+    return false;
+}
+
 ::HIR::PathParams monomorphise_path_params_with(const Span& sp, const ::HIR::PathParams& tpl, t_cb_generic callback, bool allow_infer)
 {
     ::HIR::PathParams   rv;
@@ -501,13 +581,16 @@ void HMTypeInferrence::print_pathparams(::std::ostream& os, const ::HIR::PathPar
     }
 }
 
-void HMTypeInferrence::expand_ivars(::HIR::TypeRef& type)
+void HMTypeInferrence::expand_ivars(::HIR::TypeRef& type) const
 {
     TU_MATCH(::HIR::TypeRef::Data, (type.m_data), (e),
     (Infer,
         const auto& t = this->get_type(type);
         if( &t != &type ) {
             type = t.clone();
+            // - Expand any ivars within the now-known type
+            if( !type.m_data.is_Infer() )
+                this->expand_ivars(type);
         }
         ),
     (Diverge,
@@ -566,7 +649,7 @@ void HMTypeInferrence::expand_ivars(::HIR::TypeRef& type)
         )
     )
 }
-void HMTypeInferrence::expand_ivars_params(::HIR::PathParams& params)
+void HMTypeInferrence::expand_ivars_params(::HIR::PathParams& params) const
 {
     for(auto& arg : params.m_types)
         expand_ivars(arg);
@@ -1000,23 +1083,29 @@ bool HMTypeInferrence::types_equal(const ::HIR::TypeRef& rl, const ::HIR::TypeRe
 // -------------------------------------------------------------------------------------------------------------------
 //
 // -------------------------------------------------------------------------------------------------------------------
-void TraitResolution::prep_indexes()
+::std::shared_ptr<const TypeEqualities> TypeEqualities::build(const ::HIR::Crate& crate, const ::HIR::GenericParams& params)
 {
     static Span sp_AAA;
     const Span& sp = sp_AAA;
     
+    auto rv = ::std::make_shared<TypeEqualities>();
+    
     auto add_equality = [&](::HIR::TypeRef long_ty, ::HIR::TypeRef short_ty){
         DEBUG("[prep_indexes] ADD " << long_ty << " => " << short_ty);
         // TODO: Sort the two types by "complexity" (most of the time long >= short)
-        this->m_type_equalities.insert(::std::make_pair( mv$(long_ty), mv$(short_ty) ));
+        rv->m_map.insert(::std::make_pair( mv$(long_ty), mv$(short_ty) ));
         };
     
-    this->iterate_bounds([&](const auto& b) {
+    for(const auto& b : params.m_bounds)
+    {
         TU_MATCH_DEF(::HIR::GenericBound, (b), (be),
         (
             ),
         (TraitBound,
             DEBUG("[prep_indexes] `" << be.type << " : " << be.trait);
+            if( !visit_ty_with(be.type, [](const auto& t){ return t.m_data.is_Generic(); }) ) {
+                rv->m_has_concrete_bounds = true;
+            }
             for( const auto& tb : be.trait.m_type_bounds ) {
                 DEBUG("[prep_indexes] Equality (TB) - <" << be.type << " as " << be.trait.m_path << ">::" << tb.first << " = " << tb.second);
                 auto ty_l = ::HIR::TypeRef( ::HIR::Path( be.type.clone(), be.trait.m_path.clone(), tb.first ) );
@@ -1041,7 +1130,7 @@ void TraitResolution::prep_indexes()
                 }
                 };
             
-            const auto& trait = m_crate.get_trait_by_path(sp, be.trait.m_path.m_path);
+            const auto& trait = crate.get_trait_by_path(sp, be.trait.m_path.m_path);
             for(const auto& a_ty : trait.m_types)
             {
                 ::HIR::TypeRef ty_a;
@@ -1068,11 +1157,142 @@ void TraitResolution::prep_indexes()
             add_equality( be.type.clone(), be.other_type.clone() );
             )
         )
-        return false;
-        });
+    }
+    return rv;
+}
+
+::std::shared_ptr<const TypeEqualities> TypeEqualities::get(const ::HIR::Crate& crate, const ::HIR::GenericParams* params, TypeEqualityCache* cache)
+{
+    if( !params )
+        return nullptr;
+    if( cache )
+        return cache->get(crate, *params);
+    return build(crate, *params);
+}
+
+namespace {
+    void hash_combine(size_t& h, size_t v) {
+        h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    void hash_type(size_t& h, const ::HIR::TypeRef& ty);
+    void hash_path_params(size_t& h, const ::HIR::PathParams& pp) {
+        for(const auto& t : pp.m_types)
+            hash_type(h, t);
+    }
+    void hash_generic_path(size_t& h, const ::HIR::GenericPath& gp) {
+        hash_combine(h, ::std::hash< ::std::string>()(gp.m_path.m_crate_name));
+        for(const auto& c : gp.m_path.m_components)
+            hash_combine(h, ::std::hash< ::std::string>()(c));
+        hash_path_params(h, gp.m_params);
+    }
+    // NOTE: Must only use fields that `TypeRef::ord` compares
+    void hash_type(size_t& h, const ::HIR::TypeRef& ty)
+    {
+        hash_combine(h, static_cast<size_t>(ty.m_data.tag()));
+        TU_MATCH_DEF(::HIR::TypeRef::Data, (ty.m_data), (te),
+        (
+            // Rare as equality keys, the tag is enough
+            ),
+        (Infer,
+            hash_combine(h, te.index);
+            ),
+        (Primitive,
+            hash_combine(h, static_cast<size_t>(te));
+            ),
+        (Path,
+            hash_combine(h, static_cast<size_t>(te.path.m_data.tag()));
+            TU_MATCH(::HIR::Path::Data, (te.path.m_data), (pe),
+            (Generic,
+                hash_generic_path(h, pe);
+                ),
+            (UfcsInherent,
+                hash_type(h, *pe.type);
+                hash_combine(h, ::std::hash< ::std::string>()(pe.item));
+                hash_path_params(h, pe.params);
+                ),
+            (UfcsKnown,
+                hash_type(h, *pe.type);
+                hash_generic_path(h, pe.trait);
+                hash_combine(h, ::std::hash< ::std::string>()(pe.item));
+                hash_path_params(h, pe.params);
+                ),
+            (UfcsUnknown,
+                hash_type(h, *pe.type);
+                hash_combine(h, ::std::hash< ::std::string>()(pe.item));
+                hash_path_params(h, pe.params);
+                )
+            )
+            ),
+        (Generic,
+            hash_combine(h, ::std::hash< ::std::string>()(te.name));
+            hash_combine(h, te.binding);
+            ),
+        (Array,
+            hash_type(h, *te.inner);
+            hash_combine(h, te.size_val);
+            ),
+        (Slice,
+            hash_type(h, *te.inner);
+            ),
+        (Tuple,
+            for(const auto& t : te)
+                hash_type(h, t);
+            ),
+        (Borrow,
+            hash_combine(h, static_cast<size_t>(te.type));
+            hash_type(h, *te.inner);
+            ),
+        (Pointer,
+            hash_combine(h, static_cast<size_t>(te.type));
+            hash_type(h, *te.inner);
+            )
+        )
+    }
+}
+size_t TypeEqualities::Hash::operator()(const ::HIR::TypeRef& ty) const
+{
+    size_t  h = 0;
+    hash_type(h, ty);
+    return h;
+}
+const ::HIR::TypeRef* TypeEqualities::find(const ::HIR::TypeRef& ty) const
+{
+    auto it = m_map.find(ty);
+    if( it == m_map.end() )
+        return nullptr;
+    return &it->second;
+}
+::std::ostream& operator<<(::std::ostream& os, const TypeEqualities& x)
+{
+    for(const auto& v : x.m_map)
+        os << v.first << " = " << v.second << ", ";
+    return os;
+}
+
+::std::shared_ptr<const TypeEqualities> TypeEqualityCache::get(const ::HIR::Crate& crate, const ::HIR::GenericParams& params)
+{
+    {
+        ::std::lock_guard< ::std::mutex>    lock(m_lock);
+        auto it = m_tables.find(&params);
+        if( it != m_tables.end() )
+            return it->second;
+    }
+    // Built without the lock held, if another thread got there first then its table is used
+    auto rv = TypeEqualities::build(crate, params);
+    ::std::lock_guard< ::std::mutex>    lock(m_lock);
+    return m_tables.insert( ::std::make_pair(&params, mv$(rv)) ).first->second;
+}
+
+void TraitResolution::prep_indexes(TypeEqualityCache* equality_cache)
+{
+    m_impl_equalities = TypeEqualities::get(m_crate, m_impl_params, equality_cache);
+    m_item_equalities = TypeEqualities::get(m_crate, m_item_params, equality_cache);
+    m_has_concrete_bounds = (m_impl_equalities && m_impl_equalities->m_has_concrete_bounds)
+        || (m_item_equalities && m_item_equalities->m_has_concrete_bounds);
 }
 
 
+
 ::HIR::Compare TraitResolution::compare_pp(const Span& sp, const ::HIR::PathParams& left, const ::HIR::PathParams& right) const
 {
     ASSERT_BUG( sp, left.m_types.size() == right.m_types.size(), "Parameter count mismatch" );
@@ -1088,7 +1308,7 @@ void TraitResolution::prep_indexes()
 // -------------------------------------------------------------------------------------------------------------------
 //
 // -------------------------------------------------------------------------------------------------------------------
-bool TraitResolution::iterate_bounds( ::std::function<bool(const ::HIR::GenericBound&)> cb) const
+bool TraitResolution::iterate_bounds( FunctionRef<bool(const ::HIR::GenericBound&)> cb) const
 {
     const ::HIR::GenericParams* v[2] = { m_item_params, m_impl_params };
     for(auto p : v)
@@ -1625,13 +1845,18 @@ void TraitResolution::expand_associated_types__UfcsKnown(const Span& sp, ::HIR::
             DEBUG("Assuming that " << input << " is an opaque name");
             input.m_data.as_Path().binding = ::HIR::TypeRef::TypePathBinding::make_Opaque({});
             
-            DEBUG("- " << m_type_equalities.size() << " replacements");
-            for( const auto& v : m_type_equalities )
-                DEBUG(" > " << v.first << " = " << v.second);
-            
-            auto a = m_type_equalities.find(input);
-            if( a != m_type_equalities.end() ) {
-                input = a->second.clone();
+            // - Bounds on the item take precedence over those on the impl
+            const ::HIR::TypeRef* a = nullptr;
+            if( m_item_equalities ) {
+                DEBUG("- Item: {" << *m_item_equalities << "}");
+                a = m_item_equalities->find(input);
+            }
+            if( !a && m_impl_equalities ) {
+                DEBUG("- Impl: {" << *m_impl_equalities << "}");
+                a = m_impl_equalities->find(input);
+            }
+            if( a ) {
+                input = a->clone();
             }
         }
         input = this->expand_associated_types(sp, mv$(input));
@@ -2186,7 +2411,85 @@ const ::HIR::TypeRef* TraitResolution::autoderef(const Span& sp, const ::HIR::Ty
         }
     }
 }
+bool MethodCache::Key::operator<(const Key& x) const
+{
+    if( ty != x.ty )
+        return ty < x.ty;
+    if( name != x.name )
+        return name < x.name;
+    return traits < x.traits;
+}
+MethodCache::t_map& MethodCache::get_table(const ::HIR::GenericParams* impl_params, const ::HIR::GenericParams* item_params, bool scope_dependent)
+{
+    if( !scope_dependent )
+        return m_global;
+    if( impl_params != m_scope_impl || item_params != m_scope_item ) {
+        m_scope_impl = impl_params;
+        m_scope_item = item_params;
+        m_scoped.clear();
+    }
+    return m_scoped;
+}
+
 unsigned int TraitResolution::autoderef_find_method(const Span& sp, const HIR::t_trait_list& traits, const ::HIR::TypeRef& top_ty, const ::std::string& method_name,  /* Out -> */::HIR::Path& fcn_path) const
+{
+    if( !m_method_cache || this->m_ivars.type_contains_ivars(top_ty) ) {
+        return this->autoderef_find_method_uncached(sp, traits, top_ty, method_name, fcn_path);
+    }
+    
+    MethodCache::Key    key;
+    key.ty = top_ty.clone();
+    this->m_ivars.expand_ivars(key.ty);
+    if( visit_ty_with(key.ty, [](const auto& t){ return t.m_data.is_Infer() || (t.m_data.is_Array() && t.m_data.as_Array().size_val == ~0u); }) ) {
+        // Ivars that couldn't be expanded (e.g. in a trait object) or unknown array sizes, don't cache
+        return this->autoderef_find_method_uncached(sp, traits, top_ty, method_name, fcn_path);
+    }
+    key.name = method_name;
+    // - Only the traits after the last NULL entry are searched
+    for(const auto& trait_ref : traits) {
+        if( trait_ref.first == nullptr )
+            key.traits.clear();
+        else
+            key.traits.push_back( trait_ref.first );
+    }
+    
+    bool scope_dependent = m_has_concrete_bounds || visit_ty_with(key.ty, [](const auto& t){ return t.m_data.is_Generic(); });
+    auto& table = m_method_cache->get_table(m_impl_params, m_item_params, scope_dependent);
+    auto it = table.find(key);
+    if( it != table.end() ) {
+        DEBUG("Cached - " << key.ty << "." << method_name << " = " << it->second.fcn_path << " (" << it->second.deref_count << " derefs)");
+        fcn_path = it->second.fcn_path.clone();
+        return it->second.deref_count;
+    }
+    
+    auto rv = this->autoderef_find_method_uncached(sp, traits, top_ty, method_name, fcn_path);
+    if( rv != ~0u )
+    {
+        // Store with all ivars expanded (so it's valid when used in another body)
+        auto cached_path = fcn_path.clone();
+        TU_MATCH(::HIR::Path::Data, (cached_path.m_data), (pe),
+        (Generic,
+            m_ivars.expand_ivars_params(pe.m_params);
+            ),
+        (UfcsInherent,
+            m_ivars.expand_ivars(*pe.type);
+            m_ivars.expand_ivars_params(pe.params);
+            ),
+        (UfcsKnown,
+            m_ivars.expand_ivars(*pe.type);
+            m_ivars.expand_ivars_params(pe.trait.m_params);
+            m_ivars.expand_ivars_params(pe.params);
+            ),
+        (UfcsUnknown,
+            m_ivars.expand_ivars(*pe.type);
+            m_ivars.expand_ivars_params(pe.params);
+            )
+        )
+        table.insert( ::std::make_pair(mv$(key), MethodCache::Entry { rv, mv$(cached_path) }) );
+    }
+    return rv;
+}
+unsigned int TraitResolution::autoderef_find_method_uncached(const Span& sp, const HIR::t_trait_list& traits, const ::HIR::TypeRef& top_ty, const ::std::string& method_name,  /* Out -> */::HIR::Path& fcn_path) const
 {
     unsigned int deref_count = 0;
     ::HIR::TypeRef  tmp_type;   // Temporary type used for handling Deref
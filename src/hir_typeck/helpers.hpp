@@ -6,9 +6,11 @@
 #include <hir/hir.hpp>
 #include <hir/expr.hpp>
 #include "impl_ref.hpp"
+#include <memory>
+#include <mutex>
 
 // TODO/NOTE - This is identical to ::HIR::t_cb_resolve_type
-typedef ::std::function<const ::HIR::TypeRef&(const ::HIR::TypeRef&)>   t_cb_generic;
+typedef FunctionRef<const ::HIR::TypeRef&(const ::HIR::TypeRef&)>   t_cb_generic;
 
 extern bool monomorphise_type_needed(const ::HIR::TypeRef& tpl);
 extern bool monomorphise_pathparams_needed(const ::HIR::PathParams& tpl);
@@ -24,6 +26,9 @@ extern ::HIR::TraitPath monomorphise_traitpath_with(const Span& sp, const ::HIR:
 extern ::HIR::TypeRef monomorphise_type_with(const Span& sp, const ::HIR::TypeRef& tpl, t_cb_generic callback, bool allow_infer=true);
 extern ::HIR::TypeRef monomorphise_type(const Span& sp, const ::HIR::GenericParams& params_def, const ::HIR::PathParams& params,  const ::HIR::TypeRef& tpl);
 
+/// Call the callback on `ty` and all types within it, returns true if the callback returned true for any of them
+extern bool visit_ty_with(const ::HIR::TypeRef& ty, FunctionRef<bool(const ::HIR::TypeRef&)> callback);
+
 extern void check_type_class_primitive(const Span& sp, const ::HIR::TypeRef& type, ::HIR::InferClass ic, ::HIR::CoreType ct);
 
 class HMTypeInferrence
@@ -110,13 +115,18 @@ public:
     // (helper) Add ivars to path parameters
     void add_ivars_params(::HIR::PathParams& params);
     
-    ::std::function<const ::HIR::TypeRef&(const ::HIR::TypeRef&)> callback_resolve_infer() const {
-        return [&](const auto& ty)->const auto& {
-                if( ty.m_data.is_Infer() ) 
-                    return this->get_type(ty);
-                else
-                    return ty;
-            };
+    /// Callback (for t_cb_generic/t_cb_resolve_type) that resolves ivars to their current type
+    struct CbResolveInfer {
+        const HMTypeInferrence& ctxt;
+        const ::HIR::TypeRef& operator()(const ::HIR::TypeRef& ty) const {
+            if( ty.m_data.is_Infer() )
+                return ctxt.get_type(ty);
+            else
+                return ty;
+        }
+    };
+    CbResolveInfer callback_resolve_infer() const {
+        return CbResolveInfer { *this };
     }
     
     // Mutation
@@ -129,8 +139,8 @@ public:
     ::HIR::TypeRef& get_type(::HIR::TypeRef& type);
     const ::HIR::TypeRef& get_type(const ::HIR::TypeRef& type) const;
     
-    void expand_ivars(::HIR::TypeRef& type);
-    void expand_ivars_params(::HIR::PathParams& params);
+    void expand_ivars(::HIR::TypeRef& type) const;
+    void expand_ivars_params(::HIR::PathParams& params) const;
 
     // Helpers
     bool pathparams_contain_ivars(const ::HIR::PathParams& pps) const;
@@ -142,6 +152,82 @@ private:
 };
 
 
+/// Crate-wide cache of `TraitResolution::autoderef_find_method` results
+///
+/// Only receiver types with no unknown ivars are cached. Lookups that could depend on the current generic scope
+/// (types containing generics, or scopes with bounds on concrete types) are kept in a separate table that is
+/// cleared when the scope changes.
+class MethodCache
+{
+public:
+    struct Key {
+        ::HIR::TypeRef  ty;
+        ::std::string   name;
+        /// In-scope traits (after the last scope barrier)
+        ::std::vector<const ::HIR::SimplePath*> traits;
+        
+        bool operator<(const Key& x) const;
+    };
+    struct Entry {
+        unsigned int    deref_count;
+        ::HIR::Path fcn_path;
+    };
+    typedef ::std::map<Key, Entry>  t_map;
+    
+private:
+    t_map   m_global;
+    
+    const ::HIR::GenericParams* m_scope_impl = nullptr;
+    const ::HIR::GenericParams* m_scope_item = nullptr;
+    t_map   m_scoped;
+    
+public:
+    /// Obtain the table to use for a lookup (clearing the scoped table if the scope has changed)
+    t_map& get_table(const ::HIR::GenericParams* impl_params, const ::HIR::GenericParams* item_params, bool scope_dependent);
+};
+
+class TypeEqualityCache;
+
+/// Type equalities implied by the bounds in a single generic parameter list (e.g. `<T as Trait>::Assoc = U`)
+///
+/// Read-only once built, so one table can be shared by every body within the scope.
+class TypeEqualities
+{
+    struct Hash {
+        size_t operator()(const ::HIR::TypeRef& ty) const;
+    };
+    struct Equal {
+        bool operator()(const ::HIR::TypeRef& a, const ::HIR::TypeRef& b) const {
+            return a.ord(b) == OrdEqual;
+        }
+    };
+    ::std::unordered_map< ::HIR::TypeRef, ::HIR::TypeRef, Hash, Equal>  m_map;
+    
+public:
+    /// Set if there are bounds on non-generic types (which can affect method lookup on those types)
+    bool    m_has_concrete_bounds = false;
+    
+    static ::std::shared_ptr<const TypeEqualities> build(const ::HIR::Crate& crate, const ::HIR::GenericParams& params);
+    /// Obtain the table for a parameter list (using `cache` if non-null), returns nullptr if `params` is null
+    static ::std::shared_ptr<const TypeEqualities> get(const ::HIR::Crate& crate, const ::HIR::GenericParams* params, TypeEqualityCache* cache);
+    
+    /// Returns the type that `ty` is equal to, or nullptr if there's no equality for it
+    const ::HIR::TypeRef* find(const ::HIR::TypeRef& ty) const;
+    size_t size() const { return m_map.size(); }
+    
+    friend ::std::ostream& operator<<(::std::ostream& os, const TypeEqualities& x);
+};
+/// Cache of `TypeEqualities` for each generic parameter list visited by a pass
+///
+/// NOTE: Must not outlive the pass (it's keyed on the address of the parameter list). Safe to use from multiple threads.
+class TypeEqualityCache
+{
+    ::std::mutex    m_lock;
+    ::std::unordered_map< const ::HIR::GenericParams*, ::std::shared_ptr<const TypeEqualities> >  m_tables;
+public:
+    ::std::shared_ptr<const TypeEqualities> get(const ::HIR::Crate& crate, const ::HIR::GenericParams& params);
+};
+
 class TraitResolution
 {
     const HMTypeInferrence& m_ivars;
@@ -150,16 +236,23 @@ class TraitResolution
     const ::HIR::GenericParams* m_impl_params;
     const ::HIR::GenericParams* m_item_params;
     
-    ::std::map< ::HIR::TypeRef, ::HIR::TypeRef> m_type_equalities;
+    ::std::shared_ptr<const TypeEqualities> m_impl_equalities;
+    ::std::shared_ptr<const TypeEqualities> m_item_equalities;
+    
+    MethodCache*    m_method_cache;
+    /// Set if there are bounds on non-generic types (which can affect method lookup on those types)
+    bool    m_has_concrete_bounds;
     
 public:
-    TraitResolution(const HMTypeInferrence& ivars, const ::HIR::Crate& crate, const ::HIR::GenericParams* impl_params, const ::HIR::GenericParams* item_params):
+    TraitResolution(const HMTypeInferrence& ivars, const ::HIR::Crate& crate, const ::HIR::GenericParams* impl_params, const ::HIR::GenericParams* item_params, MethodCache* method_cache=nullptr, TypeEqualityCache* equality_cache=nullptr):
         m_ivars(ivars),
         m_crate(crate),
         m_impl_params( impl_params ),
-        m_item_params( item_params )
+        m_item_params( item_params ),
+        m_method_cache( method_cache ),
+        m_has_concrete_bounds( false )
     {
-        prep_indexes();
+        prep_indexes(equality_cache);
     }
     
     const ::HIR::GenericParams& impl_params() const {
@@ -171,7 +264,7 @@ public:
         return m_item_params ? *m_item_params : empty;
     }
     
-    void prep_indexes();
+    void prep_indexes(TypeEqualityCache* equality_cache);
     
     ::HIR::Compare compare_pp(const Span& sp, const ::HIR::PathParams& left, const ::HIR::PathParams& right) const;
     
@@ -194,10 +287,10 @@ public:
     }
     
     /// Iterate over in-scope bounds (function then top)
-    bool iterate_bounds( ::std::function<bool(const ::HIR::GenericBound&)> cb) const;
+    bool iterate_bounds( FunctionRef<bool(const ::HIR::GenericBound&)> cb) const;
 
-    typedef ::std::function<bool(const ::HIR::TypeRef&, const ::HIR::PathParams&, const ::std::map< ::std::string,::HIR::TypeRef>&)> t_cb_trait_impl;
-    typedef ::std::function<bool(ImplRef, ::HIR::Compare)> t_cb_trait_impl_r;
+    typedef FunctionRef<bool(const ::HIR::TypeRef&, const ::HIR::PathParams&, const ::std::map< ::std::string,::HIR::TypeRef>&)> t_cb_trait_impl;
+    typedef FunctionRef<bool(ImplRef, ::HIR::Compare)> t_cb_trait_impl_r;
     
     /// Searches for a trait impl that matches the provided trait name and type
     bool find_trait_impls(const Span& sp, const ::HIR::SimplePath& trait, const ::HIR::PathParams& params, const ::HIR::TypeRef& type,  t_cb_trait_impl_r callback) const;
@@ -217,6 +310,9 @@ public:
     /// Locate the named method by applying auto-dereferencing.
     /// \return Number of times deref was applied (or ~0 if _ was hit)
     unsigned int autoderef_find_method(const Span& sp, const HIR::t_trait_list& traits, const ::HIR::TypeRef& top_ty, const ::std::string& method_name,  /* Out -> */::HIR::Path& fcn_path) const;
+private:
+    unsigned int autoderef_find_method_uncached(const Span& sp, const HIR::t_trait_list& traits, const ::HIR::TypeRef& top_ty, const ::std::string& method_name,  /* Out -> */::HIR::Path& fcn_path) const;
+public:
     /// Locate the named field by applying auto-dereferencing.
     /// \return Number of times deref was applied (or ~0 if _ was hit)
     unsigned int autoderef_find_field(const Span& sp, const ::HIR::TypeRef& top_ty, const ::std::string& name,  /* Out -> */::HIR::TypeRef& field_type) const;
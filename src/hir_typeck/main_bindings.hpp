@@ -2,10 +2,27 @@
  */
 #pragma once
 
+#include <vector>
+#include <string>
+
 namespace HIR {
     class Crate;
+    class ExprPtr;
+    class GenericParams;
+    class TypeRef;
+    struct Pattern;
 };
+class TypeEqualityCache;
 
 extern void Typecheck_ModuleLevel(::HIR::Crate& crate);
-extern void Typecheck_Expressions(::HIR::Crate& crate);
+/// Typecheck all expressions
+/// - If `cache_file` is non-empty, typecheck results are loaded from/saved to that file (bodies are only re-checked if
+///   they, or the crate's item signatures, have changed since it was written)
+extern void Typecheck_Expressions(::HIR::Crate& crate, const ::std::string& cache_file="");
+/// Typecheck function bodies, taking each straight through HIR expansion, validation and MIR lowering (then freeing
+/// its expression tree). Other bodies are left for the normal passes.
+extern void Typecheck_Expressions_Pipelined(::HIR::Crate& crate, const ::std::string& cache_file="");
 extern void Typecheck_Expressions_Validate(::HIR::Crate& crate);
+
+/// Validate a single body (used by the pipelined back half)
+extern void Typecheck_Expressions_ValidateOne(const ::HIR::Crate& crate, ::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, const ::std::vector< ::std::pair< ::HIR::Pattern, ::HIR::TypeRef> >& args, const ::HIR::TypeRef& ret_type, ::HIR::ExprPtr& exp, TypeEqualityCache* equality_cache=nullptr);
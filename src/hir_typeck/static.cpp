@@ -7,79 +7,6 @@
  */
 #include "static.hpp"
 
-void StaticTraitResolve::prep_indexes()
-{
-    static Span sp_AAA;
-    const Span& sp = sp_AAA;
-    
-    TRACE_FUNCTION_F("");
-    
-    auto add_equality = [&](::HIR::TypeRef long_ty, ::HIR::TypeRef short_ty){
-        DEBUG("[prep_indexes] ADD " << long_ty << " => " << short_ty);
-        // TODO: Sort the two types by "complexity" (most of the time long >= short)
-        this->m_type_equalities.insert(::std::make_pair( mv$(long_ty), mv$(short_ty) ));
-        };
-    
-    this->iterate_bounds([&](const auto& b) {
-        TU_MATCH_DEF(::HIR::GenericBound, (b), (be),
-        (
-            ),
-        (TraitBound,
-            DEBUG("[prep_indexes] `" << be.type << " : " << be.trait);
-            for( const auto& tb : be.trait.m_type_bounds ) {
-                DEBUG("[prep_indexes] Equality (TB) - <" << be.type << " as " << be.trait.m_path << ">::" << tb.first << " = " << tb.second);
-                auto ty_l = ::HIR::TypeRef( ::HIR::Path( be.type.clone(), be.trait.m_path.clone(), tb.first ) );
-                ty_l.m_data.as_Path().binding = ::HIR::TypeRef::TypePathBinding::make_Opaque({});
-                
-                add_equality( mv$(ty_l), tb.second.clone() );
-            }
-            
-            const auto& trait_params = be.trait.m_path.m_params;
-            auto cb_mono = [&](const auto& ty)->const auto& {
-                const auto& ge = ty.m_data.as_Generic();
-                if( ge.binding == 0xFFFF ) {
-                    return be.type;
-                }
-                else if( ge.binding < 256 ) {
-                    unsigned idx = ge.binding % 256;
-                    ASSERT_BUG(sp, idx < trait_params.m_types.size(), "Generic binding out of range in trait " << be.trait);
-                    return trait_params.m_types[idx];
-                }
-                else {
-                    BUG(sp, "Unknown generic binding " << ty);
-                }
-                };
-            
-            const auto& trait = m_crate.get_trait_by_path(sp, be.trait.m_path.m_path);
-            for(const auto& a_ty : trait.m_types)
-            {
-                ::HIR::TypeRef ty_a;
-                for( const auto& a_ty_b : a_ty.second.m_trait_bounds ) {
-                    DEBUG("[prep_indexes] (Assoc) " << a_ty_b);
-                    auto trait_mono = monomorphise_traitpath_with(sp, a_ty_b, cb_mono, false);
-                    for( auto& tb : trait_mono.m_type_bounds ) {
-                        if( ty_a == ::HIR::TypeRef() ) {
-                            ty_a = ::HIR::TypeRef( ::HIR::Path( be.type.clone(), be.trait.m_path.clone(), a_ty.first ) );
-                            ty_a.m_data.as_Path().binding = ::HIR::TypeRef::TypePathBinding::make_Opaque({});
-                        }
-                        DEBUG("[prep_indexes] Equality (ATB) - <" << ty_a << " as " << a_ty_b.m_path << ">::" << tb.first << " = " << tb.second);
-                        
-                        auto ty_l = ::HIR::TypeRef( ::HIR::Path( ty_a.clone(), trait_mono.m_path.clone(), tb.first ) );
-                        ty_l.m_data.as_Path().binding = ::HIR::TypeRef::TypePathBinding::make_Opaque({});
-                        
-                        add_equality( mv$(ty_l), mv$(tb.second) );
-                    }
-                }
-            }
-            ),
-        (TypeEquality,
-            DEBUG("Equality - " << be.type << " = " << be.other_type);
-            add_equality( be.type.clone(), be.other_type.clone() );
-            )
-        )
-        return false;
-        });
-}
 
 bool StaticTraitResolve::find_impl(
     const Span& sp,
@@ -613,11 +540,18 @@ void StaticTraitResolve::expand_associated_types(const Span& sp, ::HIR::TypeRef&
 void StaticTraitResolve::replace_equalities(::HIR::TypeRef& input) const
 {
     TRACE_FUNCTION_F("input="<<input);
-    DEBUG("m_type_equalities = {" << m_type_equalities << "}");
-    // - Check if there's an alias for this opaque name
-    auto a = m_type_equalities.find(input);
-    if( a != m_type_equalities.end() ) {
-        input = a->second.clone();
+    // - Check if there's an alias for this opaque name (bounds on the item take precedence over those on the impl)
+    const ::HIR::TypeRef* a = nullptr;
+    if( m_item_generics && m_item_equalities ) {
+        DEBUG("Item equalities = {" << *m_item_equalities << "}");
+        a = m_item_equalities->find(input);
+    }
+    if( !a && m_impl_generics && m_impl_equalities ) {
+        DEBUG("Impl equalities = {" << *m_impl_equalities << "}");
+        a = m_impl_equalities->find(input);
+    }
+    if( a ) {
+        input = a->clone();
         DEBUG("- Replace with " << input);
     }
 }
@@ -625,7 +559,7 @@ void StaticTraitResolve::replace_equalities(::HIR::TypeRef& input) const
 // -------------------------------------------------------------------------------------------------------------------
 //
 // -------------------------------------------------------------------------------------------------------------------
-bool StaticTraitResolve::iterate_bounds( ::std::function<bool(const ::HIR::GenericBound&)> cb) const
+bool StaticTraitResolve::iterate_bounds( FunctionRef<bool(const ::HIR::GenericBound&)> cb) const
 {
     const ::HIR::GenericParams* v[2] = { m_item_generics, m_impl_generics };
     for(auto p : v)
@@ -643,7 +577,7 @@ bool StaticTraitResolve::find_named_trait_in_trait(const Span& sp,
         const ::HIR::SimplePath& des, const ::HIR::PathParams& des_params,
         const ::HIR::Trait& trait_ptr, const ::HIR::SimplePath& trait_path, const ::HIR::PathParams& pp,
         const ::HIR::TypeRef& target_type,
-        ::std::function<void(const ::HIR::PathParams&, ::std::map< ::std::string, ::HIR::TypeRef>)> callback
+        FunctionRef<void(const ::HIR::PathParams&, ::std::map< ::std::string, ::HIR::TypeRef>)> callback
     ) const
 {
     TRACE_FUNCTION_F(des << " from " << trait_path << pp);
@@ -19,20 +19,29 @@ public:
     ::HIR::GenericParams*   m_impl_generics;
     ::HIR::GenericParams*   m_item_generics;
     
-    
-    ::std::map< ::HIR::TypeRef, ::HIR::TypeRef> m_type_equalities;
+    /// Shared between resolvers used within the same pass (optional)
+    TypeEqualityCache*  m_equality_cache;
+    ::std::shared_ptr<const TypeEqualities> m_impl_equalities;
+    ::std::shared_ptr<const TypeEqualities> m_item_equalities;
 public:
-    StaticTraitResolve(const ::HIR::Crate& crate):
+    StaticTraitResolve(const ::HIR::Crate& crate, TypeEqualityCache* equality_cache=nullptr):
         m_crate(crate),
         m_impl_generics(nullptr),
-        m_item_generics(nullptr)
+        m_item_generics(nullptr),
+        m_equality_cache(equality_cache)
+    {
+    }
+    /// Construct with a fixed generic scope (for resolving within a body processed away from the item visitor)
+    StaticTraitResolve(const ::HIR::Crate& crate, ::HIR::GenericParams* impl_generics, ::HIR::GenericParams* item_generics, TypeEqualityCache* equality_cache=nullptr):
+        m_crate(crate),
+        m_impl_generics(impl_generics),
+        m_item_generics(item_generics),
+        m_equality_cache(equality_cache),
+        m_impl_equalities( TypeEqualities::get(crate, impl_generics, equality_cache) ),
+        m_item_equalities( TypeEqualities::get(crate, item_generics, equality_cache) )
     {
-        prep_indexes();
     }
 
-private:
-    void prep_indexes();
-    
 public:
     const ::HIR::GenericParams& impl_generics() const {
         static ::HIR::GenericParams empty;
@@ -59,22 +68,20 @@ public:
     NullOnDrop< ::HIR::GenericParams> set_impl_generics(::HIR::GenericParams& gps) {
         assert( !m_impl_generics );
         m_impl_generics = &gps;
-        m_type_equalities.clear();
-        prep_indexes();
+        m_impl_equalities = TypeEqualities::get(m_crate, &gps, m_equality_cache);
         return NullOnDrop< ::HIR::GenericParams>(m_impl_generics);
     }
     NullOnDrop< ::HIR::GenericParams> set_item_generics(::HIR::GenericParams& gps) {
         assert( !m_item_generics );
         m_item_generics = &gps;
-        m_type_equalities.clear();
-        prep_indexes();
+        m_item_equalities = TypeEqualities::get(m_crate, &gps, m_equality_cache);
         return NullOnDrop< ::HIR::GenericParams>(m_item_generics);
     }
     /// \}
     
     /// \brief Lookups
     /// \{
-    typedef ::std::function<bool(ImplRef)> t_cb_find_impl;
+    typedef FunctionRef<bool(ImplRef)> t_cb_find_impl;
     
     bool find_impl(
         const Span& sp,
@@ -112,14 +119,14 @@ public:
     /// \}
     
     /// Iterate over in-scope bounds (function then top)
-    bool iterate_bounds( ::std::function<bool(const ::HIR::GenericBound&)> cb) const;
+    bool iterate_bounds( FunctionRef<bool(const ::HIR::GenericBound&)> cb) const;
 
     /// Locate a named trait in the provied trait (either itself or as a parent trait)
     bool find_named_trait_in_trait(const Span& sp,
             const ::HIR::SimplePath& des, const ::HIR::PathParams& params,
             const ::HIR::Trait& trait_ptr, const ::HIR::SimplePath& trait_path, const ::HIR::PathParams& pp,
             const ::HIR::TypeRef& self_type,
-            ::std::function<void(const ::HIR::PathParams&, ::std::map< ::std::string, ::HIR::TypeRef>)> callback
+            FunctionRef<void(const ::HIR::PathParams&, ::std::map< ::std::string, ::HIR::TypeRef>)> callback
             ) const;
     /// 
     bool trait_contains_type(const Span& sp, const ::HIR::GenericPath& trait_path, const ::HIR::Trait& trait_ptr, const ::std::string& name,  ::HIR::GenericPath& out_path) const;
@@ -0,0 +1,20 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/batch.hpp
+ * - Batch mode (compiles a list of independent crates in one invocation)
+ */
+#pragma once
+
+#include <function_ref.hpp>
+
+/// Compile every crate listed in `list_path`, running up to `max_jobs` at once (`--batch-jobs`)
+///
+/// Each line of the list is a crate root and optionally its output file (defaulting to the root with `.o` appended),
+/// blank lines and lines starting with `#` are ignored. Each crate is compiled by `compile` (given the root and output
+/// paths) in a forked child that logs to `<output>.txt`, and a pass/fail summary with per-crate times is printed at the
+/// end. Returns non-zero if any crate failed.
+///
+/// NOTE: `g_parallel_jobs` (`-j`) is left alone, so each crate also uses that many threads for its parallel passes.
+extern int Batch_Run(const char* list_path, unsigned int max_jobs, FunctionRef<int(const char* infile, const char* outfile)> compile);
@@ -0,0 +1,118 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/cache_util.hpp
+ * - Helpers shared by the on-disk caches (parse and typecheck)
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/// Thrown by `ByteReader` on truncated or malformed data
+struct CacheReadFailure {
+};
+
+/// Content hash used to validate cache entries
+typedef ::std::pair<uint64_t, uint64_t> CacheHash;
+
+/// Hash a buffer (FNV-1a, and a second multiplicative hash to reduce the chance of a collision)
+extern CacheHash hash_buffer(const ::std::string& buf);
+/// Read the whole of a file, returns false if it can't be opened
+extern bool read_file(const ::std::string& path, ::std::string& out);
+
+/// Appends values to a byte buffer (integers are LEB128 encoded)
+class ByteWriter
+{
+protected:
+    ::std::string&  m_out;
+public:
+    ByteWriter(::std::string& out):
+        m_out(out)
+    {}
+
+    void write_u8(uint8_t v) {
+        m_out.push_back( static_cast<char>(v) );
+    }
+    void write_u64(uint64_t v) {
+        while( v >= 0x80 ) {
+            write_u8( static_cast<uint8_t>(v & 0x7F) | 0x80 );
+            v >>= 7;
+        }
+        write_u8( static_cast<uint8_t>(v) );
+    }
+    void write_u64_raw(uint64_t v) {
+        for(unsigned int i = 0; i < 8; i ++)
+            write_u8( static_cast<uint8_t>(v >> (i*8)) );
+    }
+    void write_count(size_t v) {
+        write_u64(v);
+    }
+    void write_bool(bool v) {
+        write_u8(v ? 1 : 0);
+    }
+    void write_string(const ::std::string& v) {
+        write_count(v.size());
+        m_out.append(v);
+    }
+};
+
+/// Reads values written by `ByteWriter`, throwing `CacheReadFailure` if the data runs out or is malformed
+class ByteReader
+{
+protected:
+    const char* m_cur;
+    const char* m_end;
+public:
+    ByteReader(const ::std::string& buf):
+        m_cur(buf.data()),
+        m_end(buf.data() + buf.size())
+    {}
+
+    bool at_end() const {
+        return m_cur == m_end;
+    }
+    uint8_t read_u8() {
+        if( m_cur == m_end )
+            throw CacheReadFailure {};
+        return static_cast<uint8_t>(*m_cur++);
+    }
+    uint64_t read_u64() {
+        uint64_t    rv = 0;
+        for(unsigned int shift = 0; ; shift += 7)
+        {
+            if( shift >= 64 )
+                throw CacheReadFailure {};
+            auto b = read_u8();
+            rv |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if( !(b & 0x80) )
+                break;
+        }
+        return rv;
+    }
+    uint64_t read_u64_raw() {
+        uint64_t    rv = 0;
+        for(unsigned int i = 0; i < 8; i ++)
+            rv |= static_cast<uint64_t>(read_u8()) << (i*8);
+        return rv;
+    }
+    size_t read_count() {
+        auto v = read_u64();
+        // Sanity check, each counted item is at least one byte
+        if( v > static_cast<size_t>(m_end - m_cur) )
+            throw CacheReadFailure {};
+        return static_cast<size_t>(v);
+    }
+    bool read_bool() {
+        return read_u8() != 0;
+    }
+    ::std::string read_string() {
+        auto len = read_count();
+        ::std::string   rv(m_cur, len);
+        m_cur += len;
+        return rv;
+    }
+};
@@ -5,7 +5,8 @@
 #include <cassert>
 #include <functional>
 
-extern int g_debug_indent_level;
+// NOTE: Per-thread, as parallel passes (see thread_pool.hpp) emit debug from several threads
+extern thread_local int g_debug_indent_level;
 
 #ifndef DISABLE_DEBUG
 #define INDENT()    do { g_debug_indent_level += 1; assert(g_debug_indent_level<300); } while(0)
@@ -0,0 +1,50 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/function_ref.hpp
+ * - Non-owning reference to a callable
+ *
+ * Used in place of ::std::function for callbacks that are only invoked during
+ * the call (e.g. type resolution and trait impl search callbacks), avoiding the
+ * heap allocation and copy costs of ::std::function when callbacks are passed
+ * down through recursive helpers.
+ */
+#pragma once
+
+#include <memory>   // ::std::addressof
+#include <type_traits>
+#include <utility>
+
+template<typename Sig>
+class FunctionRef;
+
+/// Non-owning callable reference.
+///
+/// NOTE: Only holds a pointer to the passed callable, so must not outlive it (don't store these, pass them down).
+/// - An existing ::std::function (or any other functor) can be passed directly, and is called through this.
+template<typename R, typename... Args>
+class FunctionRef<R(Args...)>
+{
+    void*   m_obj;
+    R (*m_call)(void* obj, Args... args);
+
+    template<typename F>
+    static R call_ptr(void* obj, Args... args) {
+        // Cast so that a void FunctionRef can wrap a callable that returns a value (the result is discarded)
+        return static_cast<R>( (*static_cast<F*>(obj))( ::std::forward<Args>(args)... ) );
+    }
+public:
+    template<typename F, typename = typename ::std::enable_if< !::std::is_same<typename ::std::decay<F>::type, FunctionRef>::value >::type>
+    FunctionRef(F&& f):
+        m_obj( const_cast<void*>(static_cast<const void*>( ::std::addressof(f) )) ),
+        m_call( &call_ptr< typename ::std::remove_reference<F>::type > )
+    {
+    }
+    FunctionRef(const FunctionRef& x) = default;
+    FunctionRef& operator=(const FunctionRef& x) = default;
+
+    R operator()(Args... args) const {
+        return m_call(m_obj, ::std::forward<Args>(args)...);
+    }
+};
@@ -14,6 +14,10 @@ namespace AST {
 
 /// Parse a crate from the given file
 extern AST::Crate Parse_Crate(::std::string mainfile);
+/// Lex a single file to the end (submodules aren't followed), printing the token count and throughput
+extern void Lex_CheckFile(const ::std::string& filename);
+/// Check that a crate parses, without keeping the AST (files unchanged since they were last checked are skipped)
+extern void Parse_CheckCrate(::std::string mainfile, const ::std::string& cache_file);
 
 
 extern void Expand(::AST::Crate& crate);
@@ -21,7 +25,7 @@ extern void Expand(::AST::Crate& crate);
 /// Process #[] decorators
 extern void Process_Decorators(AST::Crate& crate);
 
-extern ::HIR::CratePtr  LowerHIR_FromAST(::AST::Crate crate);
+extern ::HIR::CratePtr  LowerHIR_FromAST(::AST::Crate& crate);
 
 /// Convert the AST to a flat tree
 extern AST::Flat Convert_Flatten(const AST::Crate& crate);
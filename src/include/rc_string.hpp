@@ -4,11 +4,18 @@
 
 #include <cstring>
 #include <ostream>
+#include <atomic>
 
 class RcString
 {
+    // NOTE: The first word is the (atomic) reference count, followed by the string data
     unsigned int*   m_ptr;
     unsigned int    m_len;
+    
+    static_assert(sizeof(::std::atomic<unsigned int>) == sizeof(unsigned int), "RcString requires a lock-free unsigned int atomic");
+    ::std::atomic<unsigned int>& refcount() const {
+        return *reinterpret_cast< ::std::atomic<unsigned int>*>(m_ptr);
+    }
 public:
     RcString():
         m_ptr(nullptr),
@@ -28,7 +35,7 @@ public:
         m_ptr(x.m_ptr),
         m_len(x.m_len)
     {
-        if( m_ptr ) *m_ptr += 1;
+        if( m_ptr ) refcount().fetch_add(1, ::std::memory_order_relaxed);
     }
     RcString(RcString&& x):
         m_ptr(x.m_ptr),
@@ -47,7 +54,7 @@ public:
             this->~RcString();
             m_ptr = x.m_ptr;
             m_len = x.m_len;
-            if( m_ptr ) *m_ptr += 1;
+            if( m_ptr ) refcount().fetch_add(1, ::std::memory_order_relaxed);
         }
         return *this;
     }
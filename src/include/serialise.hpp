@@ -12,7 +12,13 @@
 class Serialiser;
 class Deserialiser;
 
+// Serialisation is found by the Serialiser/Deserialiser templates, so value types don't need a vtable
 #define SERIALISABLE_PROTOTYPES()\
+    const char* serialise_tag() const; \
+    void serialise(::Serialiser& s) const; \
+    void deserialise(::Deserialiser& s)
+// For polymorphic types implementing the `Serialisable` interface
+#define SERIALISABLE_OVERRIDES()\
     const char* serialise_tag() const override; \
     void serialise(::Serialiser& s) const override; \
     void deserialise(::Deserialiser& s) override
@@ -56,6 +62,7 @@ public:
     {}
 };
 
+/// Virtual serialisation interface, only needed by polymorphic types (serialised through a base pointer)
 class Serialisable
 {
 public:
@@ -84,7 +91,14 @@ public:
     Serialiser& operator<<(const ::std::string& s) {
         return *this << s.c_str();
     }
-    Serialiser& operator<<(const Serialisable& subobj);
+    template<typename T>
+    auto operator<<(const T& subobj) -> decltype(subobj.serialise_tag(), *this)
+    {
+        start_object(subobj.serialise_tag());
+        subobj.serialise(*this);
+        end_object(subobj.serialise_tag());
+        return *this;
+    }
 
     template<typename T>
     Serialiser& operator<<(const ::std::vector<T>& v)
@@ -149,9 +163,17 @@ public:
     virtual void start_object(const char *tag) = 0;
     virtual void end_object(const char *tag) = 0;
     ::std::string start_object();
+    void start_object_tagged(const char *tag);
  
-    void item(Serialisable& v);
-    Deserialiser& operator>>(Serialisable& v) {
+    template<typename T>
+    auto item(T& v) -> decltype(v.deserialise(*this))
+    {
+        start_object_tagged(v.serialise_tag());
+        v.deserialise(*this);
+        end_object(v.serialise_tag());
+    }
+    template<typename T>
+    auto operator>>(T& v) -> decltype(v.deserialise(*this), *this) {
         this->item(v);
         return *this;
     }
@@ -0,0 +1,22 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/server.hpp
+ * - Compile server (serves compilations over a local socket)
+ */
+#pragma once
+
+#include <function_ref.hpp>
+
+/// Serve compile requests on the Unix socket `socket_path` (only returns on error)
+///
+/// Each request is handled in a child forked from the server, so state set up before calling this is shared by all
+/// requests while everything done by a request (globals, the crate) is discarded with the child.
+/// `handler` is called with the request's command line (`argv[0]` is a placeholder) and returns the exit code.
+extern int Server_Run(const char* socket_path, FunctionRef<int(int argc, char* argv[])> handler);
+
+/// Send a compile request (`argv` excludes the program name) to a server and wait for it to complete
+///
+/// The compiler's output goes to this process's stdout/stderr, and the compile's exit code is returned.
+extern int Server_Client(const char* socket_path, int argc, char* argv[]);
@@ -0,0 +1,21 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/thread_pool.hpp
+ * - Work-stealing pool for running independent tasks in parallel
+ */
+#pragma once
+
+#include <function_ref.hpp>
+
+/// Number of threads used by `parallel_for` (set by the `-j` command-line option, defaults to 1)
+extern unsigned int g_parallel_jobs;
+
+/// Run `count` independent tasks (called with their index) across `g_parallel_jobs` threads
+///
+/// - Each thread starts on a contiguous block of indexes, and steals half of another thread's remaining block once its
+///   own is exhausted.
+/// - With one job (or one task) all tasks are run in order on the calling thread.
+/// - If a task throws, remaining tasks are abandoned and the first exception is re-thrown once all threads have stopped.
+extern void parallel_for(unsigned int count, FunctionRef<void(unsigned int)> task);
@@ -12,7 +12,7 @@
 
 class MacroExpander;
 
-TAGGED_UNION_EX(MacroExpansionEnt, (: public Serialisable), Token, (
+TAGGED_UNION_EX(MacroExpansionEnt, (), Token, (
     // TODO: have a "raw" stream instead of just tokens
     (Token, Token),
     (NamedValue, unsigned int),
@@ -35,8 +35,7 @@ TAGGED_UNION_EX(MacroExpansionEnt, (: public Serialisable), Token, (
 extern ::std::ostream& operator<<(::std::ostream& os, const MacroExpansionEnt& x);
 
 /// Matching pattern entry
-struct MacroPatEnt:
-    public Serialisable
+struct MacroPatEnt
 {
     ::std::string   name;
     unsigned int    name_index;
@@ -92,8 +91,7 @@ struct MacroPatEnt:
 };
 
 /// Fragment of a match pattern
-struct MacroRulesPatFrag:
-    public Serialisable
+struct MacroRulesPatFrag
 {
     /// Pattern entries within this fragment
     ::std::vector<MacroPatEnt>  m_pats_ents;
@@ -110,8 +108,7 @@ struct MacroRulesPatFrag:
 };
 
 /// An expansion arm within a macro_rules! blcok
-struct MacroRulesArm:
-    public Serialisable
+struct MacroRulesArm
 {
     /// Names for the parameters
     ::std::vector< ::std::string>   m_param_names;
@@ -133,8 +130,7 @@ struct MacroRulesArm:
 };
 
 /// A sigle 'macro_rules!' block
-class MacroRules:
-    public Serialisable
+class MacroRules
 {
 public:
     bool m_exported;
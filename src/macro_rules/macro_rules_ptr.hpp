@@ -4,8 +4,7 @@
 
 class MacroRules;
 
-class MacroRulesPtr:
-    public Serialisable
+class MacroRulesPtr
 {
     MacroRules* m_ptr;
 public:
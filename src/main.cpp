@@ -15,6 +15,12 @@
 #include "ast/crate.hpp"
 #include <serialiser_texttree.hpp>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <thread_pool.hpp>
+#include <server.hpp>
+#include <batch.hpp>
 #include <main_bindings.hpp>
 #include "resolve/main_bindings.hpp"
 #include "hir_conv/main_bindings.hpp"
@@ -24,7 +30,7 @@
 
 #include "expand/cfg.hpp"
 
-int g_debug_indent_level = 0;
+thread_local int g_debug_indent_level = 0;
 ::std::string g_cur_phase;
 ::std::set< ::std::string>    g_debug_disable_map;
 
@@ -35,6 +41,7 @@ void init_debug_list()
     g_debug_disable_map.insert( "Resolve" );
     g_debug_disable_map.insert( "Resolve UFCS paths" );
     g_debug_disable_map.insert( "Typecheck Expressions" );
+    g_debug_disable_map.insert( "Typecheck Expressions (pipelined)" );
 }
 bool debug_enabled()
 {
@@ -57,6 +64,7 @@ struct ProgramParams
     static const unsigned int EMIT_C = 0x1;
     static const unsigned int EMIT_AST = 0x2;
     enum eLastStage {
+        STAGE_LEX,
         STAGE_PARSE,
         STAGE_EXPAND,
         STAGE_RESOLVE,
@@ -69,6 +77,18 @@ struct ProgramParams
     ::std::string   outfile;
     const char *crate_path = ".";
     unsigned emit_flags = EMIT_C;
+    /// Take each function body from typecheck to MIR in one go (instead of running each pass over the whole crate)
+    bool pipeline_bodies = false;
+    /// File used to cache typecheck results between runs (empty for none)
+    ::std::string   typeck_cache_file;
+    /// File used to record module files that parsed cleanly, only used with `--stop-after parse` (empty for none)
+    ::std::string   parse_cache_file;
+    /// Destroy the crate at exit (instead of leaking it), for use with leak checkers
+    bool full_teardown = false;
+    /// List of crates to compile (with the other options), instead of a single crate
+    const char *batch_list = NULL;
+    /// Number of crates from `batch_list` compiled at once (`-j` still sets the threads used by each)
+    unsigned int batch_jobs = 1;
     
     ProgramParams(int argc, char *argv[]);
 };
@@ -77,14 +97,15 @@ template <typename Rv, typename Fcn>
 Rv CompilePhase(const char *name, Fcn f) {
     ::std::cout << name << ": V V V" << ::std::endl;
     g_cur_phase = name;
-    auto start = clock();
+    // Wall-clock time (CPU time would sum over all worker threads when passes run in parallel)
+    auto start = ::std::chrono::steady_clock::now();
     auto rv = f();
-    auto end = clock();
+    auto end = ::std::chrono::steady_clock::now();
     g_cur_phase = "";
     
     //::std::cout << name << ": DONE (" << ::std::fixed << ::std::setprecision(2) << static_cast<double>(end - start) / static_cast<double>(CLOCKS_PER_SEC) << " s)" << ::std::endl;
 
-    ::std::cout <<"(" << ::std::fixed << ::std::setprecision(2) << static_cast<double>(end - start) / static_cast<double>(CLOCKS_PER_SEC) << " s) ";
+    ::std::cout <<"(" << ::std::fixed << ::std::setprecision(2) << ::std::chrono::duration<double>(end - start).count() << " s) ";
     ::std::cout << name << ": DONE";
     ::std::cout << ::std::endl;
     return rv;
@@ -93,36 +114,50 @@ template <typename Fcn>
 void CompilePhaseV(const char *name, Fcn f) {
     CompilePhase<int>(name, [&]() { f(); return 0; });
 }
+/// Release the crate (AST or HIR) just before exiting
+///
+/// Unless `--full-teardown` is passed, the crate is leaked instead of being freed node-by-node, as the OS reclaims the
+/// memory in one go at exit.
+template <typename T>
+void Teardown(const ProgramParams& params, T& crate) {
+    CompilePhaseV("Teardown", [&]() {
+        if( params.full_teardown ) {
+            T   tmp = mv$(crate);
+        }
+        else {
+            new T( mv$(crate) );
+        }
+        });
+}
 
-/// main!
-int main(int argc, char *argv[])
+/// Run the compiler over the crate described by `params`
+int CompileCrate(const ProgramParams& params)
 {
-    ProgramParams   params(argc, argv);
-    
-    // Set up cfg values
-    // TODO: Target spec
-    Cfg_SetFlag("linux");
-    Cfg_SetValue("target_pointer_width", "64");
-    Cfg_SetValue("target_endian", "little");
-    Cfg_SetValue("target_arch", "x86-noasm");   // TODO: asm! macro
-    Cfg_SetValueCb("target_has_atomic", [](const ::std::string& s) {
-        if(s == "8")    return true;    // Has an atomic byte
-        if(s == "ptr")  return true;    // Has an atomic pointer-sized value
-        return false;
-        });
-    Cfg_SetValueCb("target_feature", [](const ::std::string& s) {
-        return false;
-        });
-    
-    
     try
     {
+        if( params.last_stage == ProgramParams::STAGE_LEX ) {
+            // Lexer benchmark, only the root file is lexed
+            CompilePhaseV("Lex", [&]() {
+                Lex_CheckFile(params.infile);
+                });
+            return 0;
+        }
+        
+        if( params.last_stage == ProgramParams::STAGE_PARSE && params.parse_cache_file != "" ) {
+            // Syntax check only, the AST isn't needed
+            CompilePhaseV("Parse", [&]() {
+                Parse_CheckCrate(params.infile, params.parse_cache_file);
+                });
+            return 0;
+        }
+        
         // Parse the crate into AST
         AST::Crate crate = CompilePhase<AST::Crate>("Parse", [&]() {
             return Parse_Crate(params.infile);
             });
 
         if( params.last_stage == ProgramParams::STAGE_PARSE ) {
+            Teardown(params, crate);
             return 0;
         }
 
@@ -142,6 +177,7 @@ int main(int argc, char *argv[])
             });
 
         if( params.last_stage == ProgramParams::STAGE_EXPAND ) {
+            Teardown(params, crate);
             return 0;
         }
         
@@ -160,6 +196,7 @@ int main(int argc, char *argv[])
             });
 
         if( params.last_stage == ProgramParams::STAGE_RESOLVE ) {
+            Teardown(params, crate);
             return 0;
         }
         
@@ -168,10 +205,13 @@ int main(int argc, char *argv[])
         // --------------------------------------
         // Construc the HIR from the AST
         ::HIR::CratePtr hir_crate = CompilePhase< ::HIR::CratePtr>("HIR Lower", [&]() {
-            return LowerHIR_FromAST(mv$( crate ));
+            return LowerHIR_FromAST(crate);
             });
         // Deallocate the original crate
-        crate = ::AST::Crate();
+        // - Timed separately, freeing a large AST is a noticeable cost
+        CompilePhaseV("Free AST", [&]() {
+            crate = ::AST::Crate();
+            });
 
         // Replace type aliases (`type`) into the actual type
         CompilePhaseV("Resolve Type Aliases", [&]() {
@@ -197,9 +237,20 @@ int main(int argc, char *argv[])
             Typecheck_ModuleLevel(*hir_crate);
             });
         // Check the rest of the expressions (including function bodies)
-        CompilePhaseV("Typecheck Expressions", [&]() {
-            Typecheck_Expressions(*hir_crate);
-            });
+        if( params.pipeline_bodies && params.last_stage > ProgramParams::STAGE_TYPECK )
+        {
+            // - Function bodies go all the way to MIR here, the below passes then only handle the remaining bodies
+            //   (statics, constants, array sizes, ...)
+            CompilePhaseV("Typecheck Expressions (pipelined)", [&]() {
+                Typecheck_Expressions_Pipelined(*hir_crate, params.typeck_cache_file);
+                });
+        }
+        else
+        {
+            CompilePhaseV("Typecheck Expressions", [&]() {
+                Typecheck_Expressions(*hir_crate, params.typeck_cache_file);
+                });
+        }
         // === HIR Expansion ===
         // Annotate how each node's result is used
         CompilePhaseV("Expand HIR Annotate", [&]() {
@@ -219,6 +270,7 @@ int main(int argc, char *argv[])
             });
 
         if( params.last_stage == ProgramParams::STAGE_TYPECK ) {
+            Teardown(params, hir_crate);
             return 0;
         }
         
@@ -227,6 +279,8 @@ int main(int argc, char *argv[])
             HIR_GenerateMIR(*hir_crate);
             });
         
+        Teardown(params, hir_crate);
+        
         // Flatten modules into "mangled" set
         //g_cur_phase = "Flatten";
         //AST::Flat flat_crate = Convert_Flatten(crate);
@@ -253,6 +307,58 @@ int main(int argc, char *argv[])
     return 0;
 }
 
+/// main!
+int main(int argc, char *argv[])
+{
+    // Set up cfg values
+    // TODO: Target spec
+    Cfg_SetFlag("linux");
+    Cfg_SetValue("target_pointer_width", "64");
+    Cfg_SetValue("target_endian", "little");
+    Cfg_SetValue("target_arch", "x86-noasm");   // TODO: asm! macro
+    Cfg_SetValueCb("target_has_atomic", [](const ::std::string& s) {
+        if(s == "8")    return true;    // Has an atomic byte
+        if(s == "ptr")  return true;    // Has an atomic pointer-sized value
+        return false;
+        });
+    Cfg_SetValueCb("target_feature", [](const ::std::string& s) {
+        return false;
+        });
+    
+    // Compile server/client (see server.cpp), handled before the normal options
+    if( argc >= 2 && strcmp(argv[1], "--server") == 0 )
+    {
+        if( argc != 3 ) {
+            ::std::cerr << "Usage: " << argv[0] << " --server <socket>" << ::std::endl;
+            return 1;
+        }
+        return Server_Run(argv[2], [](int argc, char* argv[]) {
+            ProgramParams   params(argc, argv);
+            return CompileCrate(params);
+            });
+    }
+    if( argc >= 2 && strcmp(argv[1], "--client") == 0 )
+    {
+        if( argc < 3 ) {
+            ::std::cerr << "Usage: " << argv[0] << " --client <socket> <options...>" << ::std::endl;
+            return 1;
+        }
+        return Server_Client(argv[2], argc - 3, argv + 3);
+    }
+    
+    ProgramParams   params(argc, argv);
+    if( params.batch_list )
+    {
+        return Batch_Run(params.batch_list, params.batch_jobs, [&](const char* infile, const char* outfile) {
+            ProgramParams   crate_params = params;
+            crate_params.infile = infile;
+            crate_params.outfile = outfile;
+            return CompileCrate(crate_params);
+            });
+    }
+    return CompileCrate(params);
+}
+
 ProgramParams::ProgramParams(int argc, char *argv[])
 {
     // Hacky command-line parsing
@@ -279,6 +385,14 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     }
                     this->outfile = argv[++i];
                     break;
+                // "-j <n>" : Number of threads used by parallelised passes
+                case 'j':
+                    if( i == argc - 1 ) {
+                        // TODO: BAIL!
+                        exit(1);
+                    }
+                    g_parallel_jobs = ::std::max(1, atoi(argv[++i]));
+                    break;
                 default:
                     exit(1);
                 }
@@ -316,20 +430,56 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                 }
                 
                 arg = argv[++i];
-                if( strcmp(arg, "parse") == 0 )
+                if( strcmp(arg, "lex") == 0 )
+                    this->last_stage = STAGE_LEX;
+                else if( strcmp(arg, "parse") == 0 )
                     this->last_stage = STAGE_PARSE;
                 else {
                     ::std::cerr << "Unknown argument to --stop-after : '" << arg << "'" << ::std::endl;
                     exit(1);
                 }
             }
+            else if( strcmp(arg, "--pipeline") == 0 ) {
+                this->pipeline_bodies = true;
+            }
+            else if( strcmp(arg, "--full-teardown") == 0 ) {
+                this->full_teardown = true;
+            }
+            else if( strcmp(arg, "--batch") == 0 ) {
+                if( i == argc - 1 ) {
+                    // TODO: BAIL!
+                    exit(1);
+                }
+                this->batch_list = argv[++i];
+            }
+            else if( strcmp(arg, "--batch-jobs") == 0 ) {
+                if( i == argc - 1 ) {
+                    // TODO: BAIL!
+                    exit(1);
+                }
+                this->batch_jobs = ::std::max(1, atoi(argv[++i]));
+            }
+            else if( strcmp(arg, "--typeck-cache") == 0 ) {
+                if( i == argc - 1 ) {
+                    // TODO: BAIL!
+                    exit(1);
+                }
+                this->typeck_cache_file = argv[++i];
+            }
+            else if( strcmp(arg, "--parse-cache") == 0 ) {
+                if( i == argc - 1 ) {
+                    // TODO: BAIL!
+                    exit(1);
+                }
+                this->parse_cache_file = argv[++i];
+            }
             else {
                 exit(1);
             }
         }
     }
     
-    if( this->outfile == "" )
+    if( this->outfile == "" && this->infile )
     {
         this->outfile = (::std::string)this->infile + ".o";
     }
@@ -15,12 +15,14 @@
 #include <hir_typeck/helpers.hpp>   // monomorphise_type
 #include "main_bindings.hpp"
 #include "from_hir.hpp"
+#include <thread_pool.hpp>
 
 
 namespace {
     
-    class ExprVisitor_Conv:
-        public MirConverter
+    class ExprVisitor_Conv final:
+        public MirConverter,
+        public ::HIR::ExprVisitorT<ExprVisitor_Conv>
     {
         MirBuilder  m_builder;
         const ::std::vector< ::HIR::TypeRef>&  m_variable_types;
@@ -151,7 +153,13 @@ namespace {
         }
         
         // -- ExprVisitor
-        void visit(::HIR::ExprNode_Block& node) override
+        void visit_node_ptr(::HIR::ExprNodeP& node) override
+        {
+            assert(node);
+            ::HIR::visit_expr_node(*node, *this);
+        }
+        
+        void visit(::HIR::ExprNode_Block& node)
         {
             TRACE_FUNCTION_F("_Block");
             // NOTE: This doesn't create a BB, as BBs are not needed for scoping
@@ -190,7 +198,7 @@ namespace {
                 m_builder.set_result(node.span(), ::MIR::RValue::make_Tuple({}));
             }
         }
-        void visit(::HIR::ExprNode_Return& node) override
+        void visit(::HIR::ExprNode_Return& node)
         {
             TRACE_FUNCTION_F("_Return");
             this->visit_node_ptr(node.m_value);
@@ -200,7 +208,7 @@ namespace {
             //terminate_scope_early( 0 );
             m_builder.end_block( ::MIR::Terminator::make_Return({}) );
         }
-        void visit(::HIR::ExprNode_Let& node) override
+        void visit(::HIR::ExprNode_Let& node)
         {
             TRACE_FUNCTION_F("_Let");
             if( node.m_value )
@@ -211,7 +219,7 @@ namespace {
             }
             m_builder.set_result(node.span(), ::MIR::RValue::make_Tuple({}));
         }
-        void visit(::HIR::ExprNode_Loop& node) override
+        void visit(::HIR::ExprNode_Loop& node)
         {
             TRACE_FUNCTION_F("_Loop");
             //auto loop_body_scope = m_builder.new_scope(node.span());  // TODO: Does loop actually need a scope? It usually contains a block.
@@ -239,7 +247,7 @@ namespace {
             }
             m_builder.set_cur_block(loop_next);
         }
-        void visit(::HIR::ExprNode_LoopControl& node) override
+        void visit(::HIR::ExprNode_LoopControl& node)
         {
             TRACE_FUNCTION_F("_LoopControl");
             if( m_loop_stack.size() == 0 ) {
@@ -265,7 +273,7 @@ namespace {
             }
         }
         
-        void visit(::HIR::ExprNode_Match& node) override
+        void visit(::HIR::ExprNode_Match& node)
         {
             TRACE_FUNCTION_F("_Match");
             this->visit_node_ptr(node.m_value);
@@ -286,7 +294,7 @@ namespace {
             }
         } // ExprNode_Match
         
-        void visit(::HIR::ExprNode_If& node) override
+        void visit(::HIR::ExprNode_If& node)
         {
             TRACE_FUNCTION_F("_If");
             
@@ -424,7 +432,7 @@ namespace {
             }
         }
         
-        void visit(::HIR::ExprNode_Assign& node) override
+        void visit(::HIR::ExprNode_Assign& node)
         {
             TRACE_FUNCTION_F("_Assign");
             const auto& sp = node.span();
@@ -484,7 +492,7 @@ namespace {
             m_builder.set_result(node.span(), ::MIR::RValue::make_Tuple({}));
         }
         
-        void visit(::HIR::ExprNode_BinOp& node) override
+        void visit(::HIR::ExprNode_BinOp& node)
         {
             const auto& sp = node.span();
             TRACE_FUNCTION_F("_BinOp");
@@ -567,7 +575,7 @@ namespace {
             m_builder.set_result( node.span(), mv$(res) );
         }
         
-        void visit(::HIR::ExprNode_UniOp& node) override
+        void visit(::HIR::ExprNode_UniOp& node)
         {
             TRACE_FUNCTION_F("_UniOp");
             
@@ -625,7 +633,7 @@ namespace {
             }
             m_builder.set_result( node.span(), mv$(res) );
         }
-        void visit(::HIR::ExprNode_Borrow& node) override
+        void visit(::HIR::ExprNode_Borrow& node)
         {
             TRACE_FUNCTION_F("_Borrow");
             
@@ -637,7 +645,7 @@ namespace {
             m_builder.push_stmt_assign(res.as_Temporary(), ::MIR::RValue::make_Borrow({ 0, node.m_type, mv$(val) }));
             m_builder.set_result( node.span(), mv$(res) );
         }
-        void visit(::HIR::ExprNode_Cast& node) override
+        void visit(::HIR::ExprNode_Cast& node)
         {
             TRACE_FUNCTION_F("_Cast");
             this->visit_node_ptr(node.m_value);
@@ -745,7 +753,7 @@ namespace {
             m_builder.push_stmt_assign(res.clone(), ::MIR::RValue::make_Cast({ mv$(val), node.m_res_type.clone() }));
             m_builder.set_result( node.span(), mv$(res) );
         }
-        void visit(::HIR::ExprNode_Unsize& node) override
+        void visit(::HIR::ExprNode_Unsize& node)
         {
             TRACE_FUNCTION_F("_Unsize");
             this->visit_node_ptr(node.m_value);
@@ -796,7 +804,7 @@ namespace {
                 )
             )
         }
-        void visit(::HIR::ExprNode_Index& node) override
+        void visit(::HIR::ExprNode_Index& node)
         {
             TRACE_FUNCTION_F("_Index");
             
@@ -855,7 +863,7 @@ namespace {
             m_builder.set_result( node.span(), ::MIR::LValue::make_Index({ box$(index), box$(value) }) );
         }
         
-        void visit(::HIR::ExprNode_Deref& node) override
+        void visit(::HIR::ExprNode_Deref& node)
         {
             const Span& sp = node.span();
             TRACE_FUNCTION_F("_Deref");
@@ -879,7 +887,7 @@ namespace {
             m_builder.set_result( node.span(), ::MIR::LValue::make_Deref({ box$(val) }) );
         }
         
-        void visit(::HIR::ExprNode_TupleVariant& node) override
+        void visit(::HIR::ExprNode_TupleVariant& node)
         {
             TRACE_FUNCTION_F("_TupleVariant");
             ::std::vector< ::MIR::LValue>   values;
@@ -896,7 +904,7 @@ namespace {
                 }) );
         }
         
-        void visit(::HIR::ExprNode_CallPath& node) override
+        void visit(::HIR::ExprNode_CallPath& node)
         {
             TRACE_FUNCTION_F("_CallPath " << node.m_path);
             ::std::vector< ::MIR::LValue>   values;
@@ -938,7 +946,7 @@ namespace {
             m_builder.set_result( node.span(), mv$(res) );
         }
         
-        void visit(::HIR::ExprNode_CallValue& node) override
+        void visit(::HIR::ExprNode_CallValue& node)
         {
             TRACE_FUNCTION_F("_CallValue " << node.m_value->m_res_type);
             
@@ -972,12 +980,12 @@ namespace {
             m_builder.set_cur_block( next_block );
             m_builder.set_result( node.span(), mv$(res) );
         }
-        void visit(::HIR::ExprNode_CallMethod& node) override
+        void visit(::HIR::ExprNode_CallMethod& node)
         {
             // TODO: Allow use on trait objects? May not be needed, depends.
             BUG(node.span(), "Leftover _CallMethod");
         }
-        void visit(::HIR::ExprNode_Field& node) override
+        void visit(::HIR::ExprNode_Field& node)
         {
             TRACE_FUNCTION_F("_Field");
             this->visit_node_ptr(node.m_value);
@@ -994,7 +1002,7 @@ namespace {
             }
             m_builder.set_result( node.span(), ::MIR::LValue::make_Field({ box$(val), idx }) );
         }
-        void visit(::HIR::ExprNode_Literal& node) override
+        void visit(::HIR::ExprNode_Literal& node)
         {
             TRACE_FUNCTION_F("_Literal");
             TU_MATCHA( (node.m_data), (e),
@@ -1037,7 +1045,7 @@ namespace {
                 )
             )
         }
-        void visit(::HIR::ExprNode_UnitVariant& node) override
+        void visit(::HIR::ExprNode_UnitVariant& node)
         {
             TRACE_FUNCTION_F("_UnitVariant");
             m_builder.set_result( node.span(), ::MIR::RValue::make_Struct({
@@ -1045,18 +1053,18 @@ namespace {
                 {}
                 }) );
         }
-        void visit(::HIR::ExprNode_PathValue& node) override
+        void visit(::HIR::ExprNode_PathValue& node)
         {
             TRACE_FUNCTION_F("_PathValue - " << node.m_path);
             m_builder.set_result( node.span(), ::MIR::LValue::make_Static(node.m_path.clone()) );
         }
-        void visit(::HIR::ExprNode_Variable& node) override
+        void visit(::HIR::ExprNode_Variable& node)
         {
             TRACE_FUNCTION_F("_Variable - " << node.m_name << " #" << node.m_slot);
             m_builder.set_result( node.span(), ::MIR::LValue::make_Variable(node.m_slot) );
         }
         
-        void visit(::HIR::ExprNode_StructLiteral& node) override
+        void visit(::HIR::ExprNode_StructLiteral& node)
         {
             TRACE_FUNCTION_F("_StructLiteral");
             ::MIR::LValue   base_val;
@@ -1119,7 +1127,7 @@ namespace {
                 }) );
         }
         
-        void visit(::HIR::ExprNode_Tuple& node) override
+        void visit(::HIR::ExprNode_Tuple& node)
         {
             TRACE_FUNCTION_F("_Tuple");
             ::std::vector< ::MIR::LValue>   values;
@@ -1135,7 +1143,7 @@ namespace {
                 }) );
         }
         
-        void visit(::HIR::ExprNode_ArrayList& node) override
+        void visit(::HIR::ExprNode_ArrayList& node)
         {
             TRACE_FUNCTION_F("_ArrayList");
             ::std::vector< ::MIR::LValue>   values;
@@ -1151,7 +1159,7 @@ namespace {
                 }) );
         }
         
-        void visit(::HIR::ExprNode_ArraySized& node) override
+        void visit(::HIR::ExprNode_ArraySized& node)
         {
             TRACE_FUNCTION_F("_ArraySized");
             this->visit_node_ptr( node.m_val );
@@ -1163,7 +1171,7 @@ namespace {
                 }) );
         }
         
-        void visit(::HIR::ExprNode_Closure& node) override
+        void visit(::HIR::ExprNode_Closure& node)
         {
             TRACE_FUNCTION_F("_Closure - " << node.m_obj_path);
             
@@ -1209,19 +1217,40 @@ namespace {
     
     // 2. Destructure code
     ::HIR::ExprNode& root_node = const_cast<::HIR::ExprNode&>(*ptr);
-    root_node.visit( ev );
+    ::HIR::visit_expr_node(root_node, ev);
     
     return ::MIR::FunctionPointer(new ::MIR::Function(mv$(fcn)));
 }
 
 namespace {
+    typedef ::std::vector< ::std::pair< ::HIR::Pattern, ::HIR::TypeRef> >   t_args;
+    
     class OuterVisitor:
         public ::HIR::Visitor
     {
+        /// Expression body to lower (with the arguments it binds)
+        struct Body {
+            ::HIR::ExprPtr* exp;
+            const t_args*   args;
+        };
+        const t_args    m_empty_args;
+        ::std::vector<Body> m_bodies;
     public:
         OuterVisitor(const ::HIR::Crate& crate)
         {}
         
+        void visit_crate(::HIR::Crate& crate) override
+        {
+            ::HIR::Visitor::visit_crate(crate);
+            
+            // Each body is lowered independently, so do them in parallel
+            parallel_for(m_bodies.size(), [&](unsigned int i) {
+                const auto& body = m_bodies[i];
+                HIR_GenerateMIR_Expr(*body.exp, *body.args);
+                });
+            m_bodies.clear();
+        }
+        
         // NOTE: This is left here to ensure that any expressions that aren't handled by higher code cause a failure
         void visit_expr(::HIR::ExprPtr& exp) override {
             BUG(Span(), "visit_expr hit in OuterVisitor");
@@ -1233,15 +1262,14 @@ namespace {
                 this->visit_type( *e.inner );
                 DEBUG("Array size " << ty);
                 if( e.size ) {
-                    auto fcn = LowerMIR(e.size, {});
-                    e.size.m_mir = mv$(fcn);
+                    m_bodies.push_back( Body { &e.size, &m_empty_args } );
                 }
             )
             else {
                 ::HIR::Visitor::visit_type(ty);
             }
         }
-
+        
         // ------
         // Code-containing items
         // ------
@@ -1249,7 +1277,7 @@ namespace {
             if( item.m_code )
             {
                 DEBUG("Function code " << p);
-                item.m_code.m_mir = LowerMIR(item.m_code, item.m_args);
+                m_bodies.push_back( Body { &item.m_code, &item.m_args } );
             }
             else
             {
@@ -1260,14 +1288,14 @@ namespace {
             if( item.m_value )
             {
                 DEBUG("`static` value " << p);
-                item.m_value.m_mir = LowerMIR(item.m_value, {});
+                m_bodies.push_back( Body { &item.m_value, &m_empty_args } );
             }
         }
         void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
             if( item.m_value )
             {
                 DEBUG("`const` value " << p);
-                item.m_value.m_mir = LowerMIR(item.m_value, {});
+                m_bodies.push_back( Body { &item.m_value, &m_empty_args } );
             }
         }
         void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
@@ -1387,6 +1415,11 @@ void MirBuilder::pause_cur_block()
 
 // --------------------------------------------------------------------
 
+void HIR_GenerateMIR_Expr(::HIR::ExprPtr& exp, const t_args& args)
+{
+    auto fcn = LowerMIR(exp, args);
+    exp.m_mir = mv$(fcn);
+}
 void HIR_GenerateMIR(::HIR::Crate& crate)
 {
     OuterVisitor    ov(crate);
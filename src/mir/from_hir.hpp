@@ -54,10 +54,10 @@ public:
     ::MIR::BasicBlockId new_bb_unlinked();
 };
 
-class MirConverter:
-    public ::HIR::ExprVisitor
+class MirConverter
 {
 public:
+    virtual void visit_node_ptr(::HIR::ExprNodeP& node) = 0;
     virtual void destructure_from(const Span& sp, const ::HIR::Pattern& pat, ::MIR::LValue lval, bool allow_refutable=false) = 0;
 };
 
@@ -7,8 +7,15 @@
  */
 #pragma once
 
+#include <vector>
+
 namespace HIR {
 class Crate;
+class ExprPtr;
+class TypeRef;
+struct Pattern;
 }
 
 extern void HIR_GenerateMIR(::HIR::Crate& crate);
+/// Lower a single body to MIR, storing the result in `exp.m_mir`
+extern void HIR_GenerateMIR_Expr(::HIR::ExprPtr& exp, const ::std::vector< ::std::pair< ::HIR::Pattern, ::HIR::TypeRef> >& args);
@@ -543,25 +543,6 @@ ExprNodeP Parse_Expr0(TokenStream& lex)
 }
 
 
-#define LEFTASSOC(cur, _next, cases) \
-ExprNodeP _next(TokenStream& lex); \
-ExprNodeP cur(TokenStream& lex) \
-{ \
-    ExprNodeP (*next)(TokenStream&) = _next;\
-    ExprNodeP rv = next(lex); \
-    while(true) \
-    { \
-        Token   tok; \
-        switch((tok = lex.getToken()).type()) \
-        { \
-        cases \
-        default: \
-            /*::std::cout << "<<" << #cur << ::std::endl; */\
-            PUTBACK(tok, lex); \
-            return rv; \
-        } \
-    } \
-}
 bool Parse_IsTokValue(eTokenType tok_type)
 {
     switch( tok_type )
@@ -592,12 +573,12 @@ bool Parse_IsTokValue(eTokenType tok_type)
     }
     
 }
-ExprNodeP Parse_Expr1_1(TokenStream& lex);
+ExprNodeP Parse_ExprBinOp(TokenStream& lex);
 // Very evil handling for '..'
 ExprNodeP Parse_Expr1(TokenStream& lex)
 {
     Token   tok;
-    ExprNodeP (*next)(TokenStream&) = Parse_Expr1_1;
+    ExprNodeP (*next)(TokenStream&) = Parse_ExprBinOp;
     ExprNodeP   left, right;
     
     // Inclusive range to a value
@@ -637,102 +618,100 @@ ExprNodeP Parse_Expr1(TokenStream& lex)
     
     return NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::RANGE, ::std::move(left), ::std::move(right) );
 }
-// TODO: Is this left associative?
-LEFTASSOC(Parse_Expr1_1, Parse_Expr1_5,
-    case TOK_TRIPLE_DOT:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::RANGE_INC, mv$(rv), next(lex) );
-        break;
-)
-// 1: Bool OR
-LEFTASSOC(Parse_Expr1_5, Parse_Expr2,
-    case TOK_DOUBLE_PIPE:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::BOOLOR, ::std::move(rv), next(lex));
-        break;
-)
-// 2: Bool AND
-LEFTASSOC(Parse_Expr2, Parse_Expr3,
-    case TOK_DOUBLE_AMP:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::BOOLAND, ::std::move(rv), next(lex));
-        break;
-)
-// 3: (In)Equality
-LEFTASSOC(Parse_Expr3, Parse_Expr4,
-    case TOK_DOUBLE_EQUAL:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::CMPEQU, ::std::move(rv), next(lex));
-        break;
-    case TOK_EXCLAM_EQUAL:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::CMPNEQU, ::std::move(rv), next(lex));
-        break;
-)
-// 4: Comparisons
-LEFTASSOC(Parse_Expr4, Parse_Expr5,
-    case TOK_LT:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::CMPLT, ::std::move(rv), next(lex));
-        break;
-    case TOK_GT:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::CMPGT, ::std::move(rv), next(lex));
-        break;
-    case TOK_LTE:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::CMPLTE, ::std::move(rv), next(lex));
-        break;
-    case TOK_GTE:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::CMPGTE, ::std::move(rv), next(lex));
-        break;
-)
-// 5: Bit OR
-LEFTASSOC(Parse_Expr5, Parse_Expr6,
-    case TOK_PIPE:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::BITOR, ::std::move(rv), next(lex));
-        break;
-)
-// 6: Bit XOR
-LEFTASSOC(Parse_Expr6, Parse_Expr7,
-    case TOK_CARET:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::BITXOR, ::std::move(rv), next(lex));
-        break;
-)
-// 7: Bit AND
-LEFTASSOC(Parse_Expr7, Parse_Expr8,
-    case TOK_AMP:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::BITAND, ::std::move(rv), next(lex));
-        break;
-)
-// 8: Bit Shifts
-LEFTASSOC(Parse_Expr8, Parse_Expr9,
-    case TOK_DOUBLE_LT:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::SHL, ::std::move(rv), next(lex));
-        break;
-    case TOK_DOUBLE_GT:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::SHR, ::std::move(rv), next(lex));
-        break;
-)
-// 9: Add / Subtract
-LEFTASSOC(Parse_Expr9, Parse_Expr10,
-    case TOK_PLUS:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::ADD, ::std::move(rv), next(lex));
-        break;
-    case TOK_DASH:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::SUB, ::std::move(rv), next(lex));
-        break;
-)
-// 10: Times / Divide / Modulo
-LEFTASSOC(Parse_Expr10, Parse_Expr11,
-    case TOK_STAR:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::MULTIPLY, ::std::move(rv), next(lex));
-        break;
-    case TOK_SLASH:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::DIVIDE, ::std::move(rv), next(lex));
-        break;
-    case TOK_PERCENT:
-        rv = NEWNODE( AST::ExprNode_BinOp, AST::ExprNode_BinOp::MODULO, ::std::move(rv), next(lex));
-        break;
-)
-// 11: Cast
-LEFTASSOC(Parse_Expr11, Parse_Expr12,
-    case TOK_RWORD_AS:
-        rv = NEWNODE( AST::ExprNode_Cast, ::std::move(rv), Parse_Type(lex) );
-        break;
-)
+// 1-11: Binary operators and casts
+// - Parsed by precedence climbing, so an operand only recurses once per operator (instead of once per level)
+namespace {
+    /// Binding strength of a binary operator, loosest first
+    enum eBinOpPrec {
+        PREC_NONE,  // Not a binary operator
+        PREC_RANGE_INC, // `...` (TODO: Is this left associative?)
+        PREC_BOOLOR,
+        PREC_BOOLAND,
+        PREC_EQUALITY,
+        PREC_COMPARE,
+        PREC_BITOR,
+        PREC_BITXOR,
+        PREC_BITAND,
+        PREC_SHIFT,
+        PREC_ADD,
+        PREC_MUL,
+        PREC_CAST,  // `as` (right-hand side is a type)
+    };
+    struct BinOpInfo {
+        eBinOpPrec  prec;
+        AST::ExprNode_BinOp::Type   op;
+    };
+    BinOpInfo get_binop(eTokenType tok_type)
+    {
+        typedef AST::ExprNode_BinOp    BinOp;
+        switch(tok_type)
+        {
+        case TOK_TRIPLE_DOT:    return BinOpInfo { PREC_RANGE_INC, BinOp::RANGE_INC };
+        // 1: Bool OR
+        case TOK_DOUBLE_PIPE:   return BinOpInfo { PREC_BOOLOR, BinOp::BOOLOR };
+        // 2: Bool AND
+        case TOK_DOUBLE_AMP:    return BinOpInfo { PREC_BOOLAND, BinOp::BOOLAND };
+        // 3: (In)Equality
+        case TOK_DOUBLE_EQUAL:  return BinOpInfo { PREC_EQUALITY, BinOp::CMPEQU };
+        case TOK_EXCLAM_EQUAL:  return BinOpInfo { PREC_EQUALITY, BinOp::CMPNEQU };
+        // 4: Comparisons
+        case TOK_LT:    return BinOpInfo { PREC_COMPARE, BinOp::CMPLT };
+        case TOK_GT:    return BinOpInfo { PREC_COMPARE, BinOp::CMPGT };
+        case TOK_LTE:   return BinOpInfo { PREC_COMPARE, BinOp::CMPLTE };
+        case TOK_GTE:   return BinOpInfo { PREC_COMPARE, BinOp::CMPGTE };
+        // 5: Bit OR
+        case TOK_PIPE:  return BinOpInfo { PREC_BITOR, BinOp::BITOR };
+        // 6: Bit XOR
+        case TOK_CARET: return BinOpInfo { PREC_BITXOR, BinOp::BITXOR };
+        // 7: Bit AND
+        case TOK_AMP:   return BinOpInfo { PREC_BITAND, BinOp::BITAND };
+        // 8: Bit Shifts
+        case TOK_DOUBLE_LT: return BinOpInfo { PREC_SHIFT, BinOp::SHL };
+        case TOK_DOUBLE_GT: return BinOpInfo { PREC_SHIFT, BinOp::SHR };
+        // 9: Add / Subtract
+        case TOK_PLUS:  return BinOpInfo { PREC_ADD, BinOp::ADD };
+        case TOK_DASH:  return BinOpInfo { PREC_ADD, BinOp::SUB };
+        // 10: Times / Divide / Modulo
+        case TOK_STAR:      return BinOpInfo { PREC_MUL, BinOp::MULTIPLY };
+        case TOK_SLASH:     return BinOpInfo { PREC_MUL, BinOp::DIVIDE };
+        case TOK_PERCENT:   return BinOpInfo { PREC_MUL, BinOp::MODULO };
+        // 11: Cast
+        case TOK_RWORD_AS:  return BinOpInfo { PREC_CAST, BinOp::RANGE /* unused */ };
+        default:
+            return BinOpInfo { PREC_NONE, BinOp::RANGE };
+        }
+    }
+}
+ExprNodeP Parse_Expr12(TokenStream& lex);
+/// Parse a chain of binary operators that bind at least as tightly as `min_prec`
+ExprNodeP Parse_ExprBinOp(TokenStream& lex, unsigned int min_prec)
+{
+    ExprNodeP rv = Parse_Expr12(lex);
+    while(true)
+    {
+        Token   tok;
+        auto info = get_binop( GET_TOK(tok, lex) );
+        if( info.prec == PREC_NONE || info.prec < min_prec )
+        {
+            PUTBACK(tok, lex);
+            return rv;
+        }
+
+        if( info.prec == PREC_CAST )
+        {
+            rv = NEWNODE( AST::ExprNode_Cast, ::std::move(rv), Parse_Type(lex) );
+        }
+        else
+        {
+            // The right operand only takes tighter operators, so equal precedence associates to the left
+            rv = NEWNODE( AST::ExprNode_BinOp, info.op, ::std::move(rv), Parse_ExprBinOp(lex, info.prec + 1) );
+        }
+    }
+}
+ExprNodeP Parse_ExprBinOp(TokenStream& lex)
+{
+    return Parse_ExprBinOp(lex, PREC_RANGE_INC);
+}
 // 12: Type Ascription
 ExprNodeP Parse_Expr13(TokenStream& lex);
 ExprNodeP Parse_Expr12(TokenStream& lex)
@@ -1205,11 +1184,10 @@ public:
     }
 
     TokenTree   get_output() {
-        unsigned int eat = (TokenStream::m_cache_valid ? 1 : 0) + TokenStream::m_lookahead.size();
+        unsigned int eat = TokenStream::m_lookahead.size();
         DEBUG(eat << " tokens were not consumed");
         assert( m_output.size() >= eat );
         assert( m_input.m_lookahead.size() == 0 );
-        assert( m_input.m_cache_valid == false );
         for( unsigned int i = 0; i < eat; i ++ )
         {
             Token tok = m_output[ m_output.size() - eat + i ].tok();
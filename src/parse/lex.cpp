@@ -16,24 +16,74 @@
 #include "../common.hpp"
 #include <cassert>
 #include <iostream>
+#include <sstream>
 #include <cstdlib>  // strtol
+#include <cstring>  // memcmp
+#include <chrono>
+#include <iomanip>
+#if defined(__SSE2__) && defined(__GNUC__)
+# include <emmintrin.h>
+# define LEX_USE_SSE2   1
+#endif
 #include <typeinfo>
-#include <algorithm>	// std::count
 
 //const bool DEBUG_PRINT_TOKENS = false;
 const bool DEBUG_PRINT_TOKENS = true;
 
+namespace {
+    /// Returns the first position in [p, end) holding one of the given bytes (or `end`)
+    const char* find_byte3(const char* p, const char* end, char a, char b, char c)
+    {
+    #ifdef LEX_USE_SSE2
+        const __m128i   va = _mm_set1_epi8(a);
+        const __m128i   vb = _mm_set1_epi8(b);
+        const __m128i   vc = _mm_set1_epi8(c);
+        while( end - p >= 16 )
+        {
+            __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p) );
+            __m128i m = _mm_or_si128( _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)), _mm_cmpeq_epi8(v, vc) );
+            int mask = _mm_movemask_epi8(m);
+            if( mask != 0 )
+                return p + __builtin_ctz(mask);
+            p += 16;
+        }
+    #endif
+        while( p != end && *p != a && *p != b && *p != c )
+            p ++;
+        return p;
+    }
+    /// Number of UTF-8 codepoints in [p, end) (i.e. the number of `getc` calls it would take)
+    unsigned int count_codepoints(const char* p, const char* end)
+    {
+        unsigned int rv = 0;
+        for( ; p != end; p ++ )
+            rv += ((static_cast<uint8_t>(*p) & 0xC0) != 0x80);
+        return rv;
+    }
+    bool is_ascii_sym(char c)
+    {
+        return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_';
+    }
+}
+
 Lexer::Lexer(const ::std::string& filename):
     m_path(filename.c_str()),
     m_line(1),
     m_line_ofs(0),
-    m_istream(filename.c_str()),
-    m_last_char_valid(false)
+    m_pos(0),
+    m_last_char_valid(false),
+    m_last_char_pos(0)
 {
-    if( !m_istream.is_open() )
+    ::std::ifstream is(filename.c_str(), ::std::ios::binary);
+    if( !is.is_open() )
     {
         throw ::std::runtime_error("Unable to open file");
     }
+    {
+        ::std::stringstream ss;
+        ss << is.rdbuf();
+        m_buf = ss.str();
+    }
     // Consume the BOM
     if( this->getc() == '\xef' )
     {
@@ -187,41 +237,88 @@ static const struct {
   TOKENT("yield",   TOK_RWORD_YIELD),
 };
 
+namespace {
+    /// Range of TOKENMAP entries starting with each (ASCII) character
+    struct SymbolIndex {
+        uint8_t first[128];
+        uint8_t last[128];
+        
+        SymbolIndex() {
+            ::std::fill(first, first+128, 0);
+            ::std::fill(last, last+128, 0);
+            for(unsigned i = LEN(TOKENMAP); i --; )
+            {
+                auto c = static_cast<uint8_t>(TOKENMAP[i].chars[0]);
+                if( last[c] == 0 )
+                    last[c] = i + 1;
+                first[c] = i;
+            }
+        }
+    };
+    
+    /// Hash used to look up RWORDS
+    /// NOTE: The constants are chosen so there are no collisions between reserved words (checked when the table is built),
+    /// adding a word may require picking new ones.
+    unsigned int rword_hash(const char* s, size_t len)
+    {
+        return (static_cast<uint8_t>(s[0]) * 15 + static_cast<uint8_t>(s[len-1]) * 61 + static_cast<uint8_t>(s[len/2]) * 22 + len) & 127;
+    }
+    struct RWordTable {
+        int8_t  slots[128]; // Index into RWORDS, or -1
+        
+        RWordTable() {
+            ::std::fill(slots, slots+128, -1);
+            for(unsigned i = 0; i < LEN(RWORDS); i ++)
+            {
+                auto h = rword_hash(RWORDS[i].chars, RWORDS[i].len);
+                assert( slots[h] == -1 && "Collision in reserved word hash" );
+                slots[h] = i;
+            }
+        }
+    };
+    
+    /// Returns the token type for a reserved word, or TOK_NULL
+    eTokenType find_rword(const ::std::string& str)
+    {
+        static const RWordTable table;
+        if( str.empty() )
+            return TOK_NULL;
+        auto i = table.slots[ rword_hash(str.data(), str.size()) ];
+        if( i >= 0 && RWORDS[i].len == str.size() && ::std::memcmp(RWORDS[i].chars, str.data(), str.size()) == 0 )
+            return static_cast<eTokenType>(RWORDS[i].type);
+        return TOK_NULL;
+    }
+}
+
 signed int Lexer::getSymbol()
 {
-    Codepoint ch = this->getc();
-    // 1. lsearch for character
-    // 2. Consume as many characters as currently match
-    // 3. IF: a smaller character or, EOS is hit - Return current best
-    unsigned ofs = 0;
+    static const SymbolIndex index;
+    
+    // Symbols are all ASCII, so are matched directly in the buffer
+    this->unget_to_buffer();
+    if( m_pos == m_buf.size() )
+        throw Lexer::EndOfFile();
+    auto c = static_cast<uint8_t>(m_buf[m_pos]);
+    if( c >= 128 )
+        return 0;
+    
+    // Longest match among the entries starting with this character
+    // NOTE: Every prefix of a symbol is also in the table, so this consumes the same as a character-by-character walk
+    const char* p = m_buf.data() + m_pos;
+    size_t  avail = m_buf.size() - m_pos;
     signed int best = 0;
-    for(unsigned i = 0; i < LEN(TOKENMAP); i ++)
+    size_t  best_len = 0;
+    for(unsigned i = index.first[c]; i < index.last[c]; i ++)
     {
-        const char* const chars = TOKENMAP[i].chars;
         const size_t len = TOKENMAP[i].len;
-
-        if( ofs >= len || static_cast<uint32_t>(chars[ofs]) > ch.v ) {
-            this->ungetc();
-            return best;
-        }
-
-        while( chars[ofs] && ch == chars[ofs] )
-        {
-            try {
-                ch = this->getc();
-            }
-            catch(Lexer::EndOfFile) {
-                ch = 0;
-            }
-            ofs ++;
-        }
-        if( chars[ofs] == 0 )
+        if( len > best_len && len <= avail && ::std::memcmp(p, TOKENMAP[i].chars, len) == 0 )
         {
             best = TOKENMAP[i].type;
+            best_len = len;
         }
     }
-
-    this->ungetc();
+    m_pos += best_len;
+    m_line_ofs += best_len;
     return best;
 }
 
@@ -255,12 +352,6 @@ Token Lexer::realGetToken()
             continue;
         case TOK_WHITESPACE:
             continue;
-        case TOK_COMMENT: {
-            ::std::string comment = tok.str();
-            unsigned int c = ::std::count(comment.begin(), comment.end(), '\n');
-            m_line += c;
-            //DEBUG("m_line = " << m_line << " (comment w/ "<<c<<")");
-            continue; }
         default:
             return tok;
         }
@@ -306,9 +397,11 @@ Token Lexer::getTokenInt()
             return Token(TOK_NEWLINE);
         if( ch.isspace() )
         {
-            while( (ch = this->getc()).isspace() && ch != '\n' )
-                ;
-            this->ungetc();
+            while( m_pos < m_buf.size() && m_buf[m_pos] != '\n' && Codepoint(static_cast<uint8_t>(m_buf[m_pos])).isspace() )
+            {
+                m_pos ++;
+                m_line_ofs ++;
+            }
             return Token(TOK_WHITESPACE);
         }
         this->ungetc();
@@ -559,53 +652,59 @@ Token Lexer::getTokenInt()
         {
             switch(sym)
             {
+            // Comments are skipped directly in the buffer, their text isn't used
             case LINECOMMENT: {
-                // Line comment
-                ::std::string   str;
-                auto ch = this->getc();
-                while(ch != '\n' && ch != '\r')
-                {
-                    str += ch;
-                    ch = this->getc();
-                }
-                this->ungetc();
-                return Token(TOK_COMMENT, str); }
+                this->unget_to_buffer();
+                const char* start = m_buf.data() + m_pos;
+                const char* end = m_buf.data() + m_buf.size();
+                const char* p = find_byte3(start, end, '\n', '\r', '\r');
+                m_line_ofs += count_codepoints(start, p);
+                m_pos = p - m_buf.data();
+                if( p == end )
+                    return Token(TOK_EOF);
+                return Token(TOK_WHITESPACE); }
             case BLOCKCOMMENT: {
-                ::std::string   str;
+                this->unget_to_buffer();
+                const char* start = m_buf.data() + m_pos;
+                const char* end = m_buf.data() + m_buf.size();
+                const char* p = start;
                 unsigned int level = 0;
+                unsigned int lines = 0;
+                bool closed = false;
                 while(true)
                 {
-                    ch = this->getc();
-                    
-                    if( ch == '/' ) {
-                        str += ch;
-                        ch = this->getc();
-                        if( ch == '*' ) {
+                    p = find_byte3(p, end, '\n', '/', '*');
+                    if( p == end )
+                        break;
+                    char c = *p++;
+                    if( c == '\n' ) {
+                        lines ++;
+                        continue ;
+                    }
+                    // The character after a '/' or '*' is always consumed
+                    if( p == end )
+                        break;
+                    char c2 = *p++;
+                    if( c2 == '\n' )
+                        lines ++;
+                    if( c == '/' ) {
+                        if( c2 == '*' )
                             level ++;
-                        }
-                        str += ch;
                     }
-                    else {
-                        if( ch == '*' ) {
-                            ch = this->getc();
-                            if( ch == '/' ) {
-                                if( level == 0 )
-                                    break;
-                                level --;
-                                str.push_back('*');
-                                str.push_back('/');
-                            }
-                            else {
-                                str.push_back('*');
-                                str += ch;
-                            }
-                        }
-                        else {
-                            str += ch;
+                    else if( c2 == '/' ) {
+                        if( level == 0 ) {
+                            closed = true;
+                            break;
                         }
+                        level --;
                     }
                 }
-                return Token(TOK_COMMENT, str); }
+                m_line_ofs += count_codepoints(start, p);
+                m_pos = p - m_buf.data();
+                if( !closed )
+                    return Token(TOK_EOF);
+                m_line += lines;
+                return Token(TOK_WHITESPACE); }
             case SINGLEQUOTE: {
                 auto firstchar = this->getc();
                 if( firstchar.v == '\\' ) {
@@ -745,22 +844,29 @@ Token Lexer::getTokenInt_Identifier(Codepoint leader, Codepoint leader2)
     while( issym(ch) )
     {
         str += ch;
+        // ASCII fast path, take the rest of a plain identifier straight from the buffer
+        if( !m_last_char_valid )
+        {
+            size_t start = m_pos;
+            while( m_pos < m_buf.size() && is_ascii_sym(m_buf[m_pos]) )
+                m_pos ++;
+            str.append(m_buf, start, m_pos - start);
+            m_line_ofs += m_pos - start;
+        }
         ch = this->getc();
     }
 
     if( ch == '!' )
     {
-        return Token(TOK_MACRO, str);
+        return Token(TOK_MACRO, mv$(str));
     }
     else
     {
         this->ungetc();
-        for( unsigned int i = 0; i < LEN(RWORDS); i ++ )
-        {
-            if( str < RWORDS[i].chars ) break;
-            if( str == RWORDS[i].chars )    return Token((enum eTokenType)RWORDS[i].type);
-        }
-        return Token(TOK_IDENT, str);
+        auto rword = find_rword(str);
+        if( rword != TOK_NULL )
+            return Token(rword);
+        return Token(TOK_IDENT, mv$(str));
     }
 }
 
@@ -864,10 +970,9 @@ uint32_t Lexer::parseEscape(char enclosing)
 
 char Lexer::getc_byte()
 {
-    char rv = m_istream.get();
-    if( m_istream.eof() )
+    if( m_pos == m_buf.size() )
         throw Lexer::EndOfFile();
-    return rv;
+    return m_buf[m_pos++];
 }
 Codepoint Lexer::getc()
 {
@@ -877,7 +982,9 @@ Codepoint Lexer::getc()
     }
     else
     {
+        size_t pos = m_pos;
         m_last_char = this->getc_cp();
+        m_last_char_pos = pos;
         m_line_ofs += 1;
     }
     //::std::cout << "getc(): '" << m_last_char << "'" << ::std::endl;
@@ -955,6 +1062,16 @@ void Lexer::ungetc()
     assert(!m_last_char_valid);
     m_last_char_valid = true;
 }
+/// Undo a pending `ungetc` so the buffer can be scanned directly from `m_pos`
+void Lexer::unget_to_buffer()
+{
+    if( m_last_char_valid )
+    {
+        m_pos = m_last_char_pos;
+        m_line_ofs -= 1;
+        m_last_char_valid = false;
+    }
+}
 
 TTStream::TTStream(const TokenTree& input_tt)
 {
@@ -1046,8 +1163,34 @@ Position TTStreamO::getPosition() const
 }
 
 
-TokenStream::TokenStream():
-    m_cache_valid(false)
+void TokenRing::grow()
+{
+    ::std::vector<Token>    new_slots( m_slots.empty() ? 8 : m_slots.size() * 2 );
+    for(size_t i = 0; i < m_count; i ++)
+        new_slots[i] = mv$( m_slots[ (m_head + i) & (m_slots.size() - 1) ] );
+    m_slots = mv$(new_slots);
+    m_head = 0;
+}
+
+
+void Lex_CheckFile(const ::std::string& filename)
+{
+    Lexer   lex(filename);
+    size_t  n_tokens = 0;
+    // Reads directly from the lexer, bypassing the lookahead buffer and token debug output
+    auto start = ::std::chrono::steady_clock::now();
+    while( lex.realGetToken().type() != TOK_EOF )
+        n_tokens ++;
+    auto end = ::std::chrono::steady_clock::now();
+
+    double  secs = ::std::chrono::duration<double>(end - start).count();
+    double  mbytes = static_cast<double>(lex.source_size()) / (1024.0 * 1024.0);
+    ::std::cout << filename << ": " << n_tokens << " tokens, " << lex.source_size() << " bytes in "
+        << ::std::fixed << ::std::setprecision(4) << secs << " s"
+        << " (" << ::std::setprecision(2) << (secs > 0 ? mbytes / secs : 0.0) << " MB/s)" << ::std::endl;
+}
+
+TokenStream::TokenStream()
 {
 }
 TokenStream::~TokenStream()
@@ -1064,55 +1207,32 @@ Token TokenStream::innerGetToken()
 }
 Token TokenStream::getToken()
 {
-    if( m_cache_valid )
-    {
-        m_cache_valid = false;
-        return mv$(m_cache);
-    }
-    else if( m_lookahead.size() )
+    if( m_putback_count > 0 )
     {
-        Token ret = mv$( m_lookahead.front() );
-        m_lookahead.erase(m_lookahead.begin());
-        if( DEBUG_PRINT_TOKENS ) {
-            ::std::cout << "getToken[" << typeid(*this).name() << "] - " << ret.get_pos() << "-" << ret << ::std::endl;
-        }
-        return ret;
+        m_putback_count --;
+        return m_lookahead.pop_front();
     }
-    else
-    {
-        Token ret = this->innerGetToken();
-        if( DEBUG_PRINT_TOKENS ) {
-            ::std::cout << "getToken[" << typeid(*this).name() << "] - " << ret.get_pos() << "-" << ret << ::std::endl;
-        }
-        return ret;
+    Token ret = m_lookahead.empty() ? this->innerGetToken() : m_lookahead.pop_front();
+    if( DEBUG_PRINT_TOKENS ) {
+        ::std::cout << "getToken[" << typeid(*this).name() << "] - " << ret.get_pos() << "-" << ret << ::std::endl;
     }
+    return ret;
 }
 void TokenStream::putback(Token tok)
 {
-    if( m_cache_valid )
-    {
-        DEBUG("" << getPosition() << " - Double putback: " << tok << " but " << m_cache);
-        throw ParseError::BugCheck("Double putback");
-    }
-    else
-    {
-        m_cache_valid = true;
-        m_cache = mv$(tok);
-    }
+    m_lookahead.push_front( mv$(tok) );
+    m_putback_count ++;
 }
 
 eTokenType TokenStream::lookahead(unsigned int i)
 {
-    const unsigned int MAX_LOOKAHEAD = 3;
+    const unsigned int MAX_LOOKAHEAD = 4;
     
-    if( m_cache_valid )
-    {
-        if( i == 0 )
-            return m_cache.type();
-        i --;
-    }
+    if( i < m_putback_count )
+        return m_lookahead[i].type();
     
-    if( i >= MAX_LOOKAHEAD )
+    // Only tokens read ahead from the lexer count against the limit, put-back tokens are free
+    if( i >= m_lookahead.size() && i - m_putback_count >= MAX_LOOKAHEAD )
         throw ParseError::BugCheck("Excessive lookahead");
     
     while( i >= m_lookahead.size() )
@@ -23,6 +23,8 @@ namespace AST {
     class MetaItems;
 }
 
+struct DeferredModFiles;
+
 /// State the parser needs to pass down via a second channel.
 struct ParseState
 {
@@ -34,6 +36,9 @@ struct ParseState
     ::AST::Module*  module = nullptr;
     ::AST::MetaItems*   parent_attrs = nullptr;
     
+    // If set, `mod foo;` files found in the root module of the current file are queued here (to be parsed later)
+    DeferredModFiles*   deferred_mod_files = nullptr;
+    
     ::AST::Module& get_current_mod() {
         assert(this->module);
         return *this->module;
@@ -48,13 +53,52 @@ struct ParseState
     }
 };
 
+/// Ring buffer of tokens that have been read from the source but not yet consumed.
+/// Lookahead pushes to the back, putback pushes to the front, both are O(1) and grow only when full.
+class TokenRing
+{
+    ::std::vector<Token>    m_slots;    // Capacity is always a power of two
+    size_t  m_head = 0;
+    size_t  m_count = 0;
+public:
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    
+    const Token& operator[](size_t i) const {
+        assert(i < m_count);
+        return m_slots[ (m_head + i) & (m_slots.size() - 1) ];
+    }
+    
+    void push_back(Token tok) {
+        if( m_count == m_slots.size() )
+            grow();
+        m_slots[ (m_head + m_count) & (m_slots.size() - 1) ] = ::std::move(tok);
+        m_count ++;
+    }
+    void push_front(Token tok) {
+        if( m_count == m_slots.size() )
+            grow();
+        m_head = (m_head - 1) & (m_slots.size() - 1);
+        m_slots[m_head] = ::std::move(tok);
+        m_count ++;
+    }
+    Token pop_front() {
+        assert(m_count > 0);
+        Token rv = ::std::move(m_slots[m_head]);
+        m_head = (m_head + 1) & (m_slots.size() - 1);
+        m_count --;
+        return rv;
+    }
+private:
+    void grow();
+};
+
 class TokenStream
 {
     friend class TTLexer;   // needs access to internals to know what was consumed
     
-    bool    m_cache_valid;
-    Token   m_cache;
-    ::std::vector<Token>    m_lookahead;
+    TokenRing   m_lookahead;
+    unsigned int    m_putback_count = 0;    // Number of tokens at the front of `m_lookahead` that were put back
     ParseState  m_parse_state;
 public:
     TokenStream();
@@ -121,13 +165,20 @@ class Lexer:
     unsigned int m_line;
     unsigned int m_line_ofs;
 
-    ::std::ifstream m_istream;
+    /// Entire source file, lexed in-place
+    ::std::string   m_buf;
+    size_t  m_pos;
     bool    m_last_char_valid;
     Codepoint   m_last_char;
+    /// Offset of `m_last_char` in `m_buf`, used to undo an `ungetc` before scanning the buffer directly
+    size_t  m_last_char_pos;
     Token   m_next_token;   // Used when lexing generated two tokens
 public:
     Lexer(const ::std::string& filename);
 
+    /// Size of the source file in bytes
+    size_t source_size() const { return m_buf.size(); }
+
     virtual Position getPosition() const override;
     virtual Token realGetToken() override;
 
@@ -141,6 +192,7 @@ private:
     uint32_t parseEscape(char enclosing);
 
     void ungetc();
+    void unget_to_buffer();
     Codepoint getc_num();
     Codepoint getc();
     Codepoint getc_cp();
@@ -0,0 +1,159 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * parse/parse_cache.cpp
+ * - On-disk record of module files that parsed cleanly
+ *
+ * The cache file is a flat binary list of entries, each keyed on the file path and the path/flags it was parsed
+ * with (so the same file reached in a different way is a different entry).
+ */
+#include "parse_cache.hpp"
+#include <common.hpp>
+#include <span.hpp>
+#include <fstream>
+
+namespace {
+    /// Bumped whenever the stored format (or the parser's acceptance of a file) changes
+    const uint32_t CACHE_VERSION = 2;
+    const char CACHE_MAGIC[] = "MRUSTC-PARSE";
+
+    ::std::string make_key(const ParseCache::ModFile& file)
+    {
+        ::std::string   rv = file.file_path;
+        rv += '\0';
+        rv += file.mod_path;
+        rv += '\0';
+        rv += (file.file_controls_dir ? '1' : '0');
+        return rv;
+    }
+}
+
+ParseCache::ParseCache(::std::string path):
+    m_path( mv$(path) )
+{
+}
+
+bool ParseCache::hash_file(const ::std::string& path, Hash& out_hash)
+{
+    ::std::string   buf;
+    if( !read_file(path, buf) )
+        return false;
+    out_hash = hash_buffer(buf);
+    return true;
+}
+bool ParseCache::module_file_exists(const ::std::string& path)
+{
+    ::std::ifstream is(path);
+    return is.is_open();
+}
+
+void ParseCache::load()
+{
+    TRACE_FUNCTION_F(m_path);
+    ::std::string   buf;
+    if( !read_file(m_path, buf) ) {
+        DEBUG("No cache file");
+        return ;
+    }
+
+    try
+    {
+        ByteReader  r { buf };
+        if( r.read_string() != CACHE_MAGIC )
+            throw CacheReadFailure {};
+        if( r.read_u64() != CACHE_VERSION )
+            throw CacheReadFailure {};
+        auto count = r.read_count();
+        for(size_t i = 0; i < count; i ++)
+        {
+            auto key = r.read_string();
+            Entry   ent;
+            ent.content_hash.first = r.read_u64();
+            ent.content_hash.second = r.read_u64();
+            auto n_files = r.read_count();
+            for(size_t j = 0; j < n_files; j ++)
+            {
+                ModFile f;
+                f.file_path = r.read_string();
+                f.mod_path = r.read_string();
+                f.file_controls_dir = r.read_bool();
+                ent.result.mod_files.push_back( mv$(f) );
+            }
+            auto n_probes = r.read_count();
+            for(size_t j = 0; j < n_probes; j ++)
+            {
+                Probe   p;
+                p.path = r.read_string();
+                p.exists = r.read_bool();
+                ent.result.probes.push_back( mv$(p) );
+            }
+            m_loaded.insert( ::std::make_pair(mv$(key), mv$(ent)) );
+        }
+        if( !r.at_end() )
+            throw CacheReadFailure {};
+    }
+    catch(const CacheReadFailure& )
+    {
+        DEBUG("Malformed cache file, ignoring");
+        m_loaded.clear();
+    }
+    DEBUG(m_loaded.size() << " entries loaded");
+}
+
+void ParseCache::save() const
+{
+    TRACE_FUNCTION_F(m_path);
+
+    ::std::string   buf;
+    ByteWriter  w { buf };
+    w.write_string(CACHE_MAGIC);
+    w.write_u64(CACHE_VERSION);
+    w.write_count(m_current.size());
+    for(const auto& ent : m_current)
+    {
+        w.write_string(ent.first);
+        w.write_u64(ent.second.content_hash.first);
+        w.write_u64(ent.second.content_hash.second);
+        w.write_count(ent.second.result.mod_files.size());
+        for(const auto& f : ent.second.result.mod_files)
+        {
+            w.write_string(f.file_path);
+            w.write_string(f.mod_path);
+            w.write_bool(f.file_controls_dir);
+        }
+        w.write_count(ent.second.result.probes.size());
+        for(const auto& p : ent.second.result.probes)
+        {
+            w.write_string(p.path);
+            w.write_bool(p.exists);
+        }
+    }
+
+    ::std::ofstream os(m_path, ::std::ios::binary);
+    os.write(buf.data(), buf.size());
+    if( !os.good() ) {
+        WARNING(Span(), W0000, "Unable to write parse cache to " << m_path);
+    }
+}
+
+const ParseCache::Result* ParseCache::lookup(const ModFile& file, const Hash& content_hash) const
+{
+    auto it = m_loaded.find( make_key(file) );
+    if( it == m_loaded.end() || it->second.content_hash != content_hash )
+        return nullptr;
+    // - A module file appearing, disappearing, or moving between `name.rs` and `name/mod.rs` changes the result
+    for(const auto& p : it->second.result.probes)
+    {
+        if( module_file_exists(p.path) != p.exists ) {
+            DEBUG("Module file " << p.path << (p.exists ? " removed" : " added"));
+            return nullptr;
+        }
+    }
+    return &it->second.result;
+}
+
+void ParseCache::store(const ModFile& file, const Hash& content_hash, Result result)
+{
+    m_current[ make_key(file) ] = Entry { content_hash, mv$(result) };
+}
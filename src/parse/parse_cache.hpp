@@ -0,0 +1,77 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * parse/parse_cache.hpp
+ * - On-disk record of module files that parsed cleanly
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cache_util.hpp>
+
+/// Cache of parse results, persisted between runs
+///
+/// Only used when the AST is discarded after parsing (`--stop-after parse`). A module file whose contents and location
+/// are unchanged since it last parsed cleanly isn't parsed again, only the module files it loads are visited.
+///
+/// Which module files a file loads also depends on which candidate paths (`name.rs` or `name/mod.rs`) exist, so every
+/// path probed is recorded and re-checked before an entry is used.
+class ParseCache
+{
+public:
+    typedef CacheHash   Hash;
+
+    /// A module source file, and how it was reached
+    struct ModFile {
+        ::std::string   file_path;
+        /// Path passed to Parse_ModRoot
+        ::std::string   mod_path;
+        bool    file_controls_dir;
+    };
+    /// A candidate module file path checked while parsing, and whether it existed
+    struct Probe {
+        ::std::string   path;
+        bool    exists;
+    };
+    /// What parsing a file found
+    struct Result {
+        /// Out-of-line module files loaded by this file (including those from inline modules)
+        ::std::vector<ModFile>  mod_files;
+        /// Every candidate module path checked while finding the above
+        ::std::vector<Probe>    probes;
+    };
+
+private:
+    struct Entry {
+        Hash    content_hash;
+        Result  result;
+    };
+
+    ::std::string   m_path;
+    /// Entries read from the cache file
+    ::std::map< ::std::string, Entry>   m_loaded;
+    /// Entries for files visited this run (only these are written back)
+    ::std::map< ::std::string, Entry>   m_current;
+
+public:
+    ParseCache(::std::string path);
+
+    void load();
+    void save() const;
+
+    /// Hash the current contents of a source file, returns false if it can't be read
+    static bool hash_file(const ::std::string& path, Hash& out_hash);
+    /// Check if a candidate module file exists (the same check the parser makes)
+    static bool module_file_exists(const ::std::string& path);
+
+    /// Returns what parsing `file` found if neither it nor any of its probed paths have changed since it was stored,
+    /// nullptr otherwise
+    /// NOTE: Safe to call from multiple threads (as long as `store` isn't called at the same time)
+    const Result* lookup(const ModFile& file, const Hash& content_hash) const;
+    /// Record that `file` parsed cleanly
+    void store(const ModFile& file, const Hash& content_hash, Result result);
+};
@@ -7,13 +7,16 @@
  *
  * Entrypoint:
  * - Parse_Crate : Handles crate attrbutes, and passes on to Parse_ModRoot
+ * - Parse_CheckCrate : Syntax check only, skipping files that are unchanged since they last parsed cleanly
  * - Parse_ModRoot
  */
 #include "../ast/ast.hpp"
 #include "../ast/crate.hpp"
 #include "parseerror.hpp"
 #include "common.hpp"
+#include "parse_cache.hpp"
 #include <cassert>
+#include <thread_pool.hpp>
 
 template<typename T>
 Spanned<T> get_spanned(TokenStream& lex, ::std::function<T()> f) {
@@ -36,6 +39,27 @@ Spanned<T> get_spanned(TokenStream& lex, ::std::function<T()> f) {
 AST::MetaItem   Parse_MetaItem(TokenStream& lex);
 void Parse_ModRoot(TokenStream& lex, AST::Module& mod, AST::MetaItems& mod_attrs, bool file_controls_dir, const ::std::string& path);
 
+/// Out-of-line module files found while parsing a file, parsed once that file is complete (see Parse_Crate)
+struct DeferredModFiles
+{
+    struct Ent {
+        /// Index of the (still empty) module item in `mod`
+        size_t  item_idx;
+        ::std::string   file_path;
+        /// Path passed to Parse_ModRoot
+        ::std::string   mod_path;
+        bool    file_controls_dir;
+    };
+    
+    /// Root module of the file (only items directly in this module are deferred, as inline modules get moved)
+    AST::Module*    mod;
+    ::std::vector<Ent>  ents;
+    /// Also defer files from inline modules (only valid if the parsed modules are discarded)
+    bool    all_modules = false;
+    /// Every candidate module file checked, and whether it was found (used to validate cached results)
+    ::std::vector< ::std::pair< ::std::string, bool> >  probes;
+};
+
 ::std::vector< ::std::string> Parse_HRB(TokenStream& lex)
 {
     TRACE_FUNCTION;
@@ -1593,6 +1617,14 @@ void Parse_Mod_Item(TokenStream& lex, bool file_controls_dir, const ::std::strin
                 ::std::string newpath_file = path_attr.size() > 0 ? sub_path : sub_path + ".rs";
                 ::std::ifstream ifs_dir (newpath_dir + "mod.rs");
                 ::std::ifstream ifs_file(newpath_file);
+                ::std::string   sub_file;
+                ::std::string   sub_mod_path;
+                auto* deferred = lex.parse_state().deferred_mod_files;
+                if( deferred )
+                {
+                    deferred->probes.push_back( ::std::make_pair(newpath_dir + "mod.rs", ifs_dir.is_open()) );
+                    deferred->probes.push_back( ::std::make_pair(newpath_file, ifs_file.is_open()) );
+                }
                 if( ifs_dir.is_open() && ifs_file.is_open() )
                 {
                     // Collision
@@ -1601,22 +1633,33 @@ void Parse_Mod_Item(TokenStream& lex, bool file_controls_dir, const ::std::strin
                 else if( ifs_dir.is_open() )
                 {
                     // Load from dir
-                    Lexer sub_lex(newpath_dir + "mod.rs");
-                    Parse_ModRoot(sub_lex, submod, meta_items, sub_file_controls_dir, newpath_dir);
-                    GET_CHECK_TOK(tok, sub_lex, TOK_EOF);
+                    sub_file = newpath_dir + "mod.rs";
+                    sub_mod_path = newpath_dir;
                 }
                 else if( ifs_file.is_open() )
                 {
                     // Load from file
-                    Lexer sub_lex(newpath_file);
-                    Parse_ModRoot(sub_lex, submod, meta_items, sub_file_controls_dir, newpath_file);
-                    GET_CHECK_TOK(tok, sub_lex, TOK_EOF);
+                    sub_file = newpath_file;
+                    sub_mod_path = newpath_file;
                 }
                 else
                 {
                     // Can't find file
                     throw ParseError::Generic(lex, FMT("Can't find file for '" << name << "' in '" << file_path << "'") );
                 }
+                
+                if( deferred && (deferred->all_modules || deferred->mod == &mod) )
+                {
+                    // - Left empty for now, filled once this file is done
+                    DEBUG("Deferring " << sub_file);
+                    deferred->ents.push_back( DeferredModFiles::Ent { mod.items().size(), mv$(sub_file), mv$(sub_mod_path), sub_file_controls_dir } );
+                }
+                else
+                {
+                    Lexer sub_lex(sub_file);
+                    Parse_ModRoot(sub_lex, submod, meta_items, sub_file_controls_dir, sub_mod_path);
+                    GET_CHECK_TOK(tok, sub_lex, TOK_EOF);
+                }
             }
             break;
         default:
@@ -1709,6 +1752,67 @@ void Parse_ModRoot(TokenStream& lex, AST::Module& mod, AST::MetaItems& mod_attrs
     Parse_ModRoot_Items(lex, mod, file_controls_dir, path);
 }
 
+namespace {
+    /// Parse queued module files (and the files they queue) in parallel, a level of the module tree at a time
+    void Parse_DeferredModFiles(DeferredModFiles root_files)
+    {
+        struct Task {
+            AST::Module*    parent;
+            const DeferredModFiles::Ent*    ent;
+            
+            AST::Module mod;
+            AST::MetaItems  attrs;
+            DeferredModFiles    sub_files;
+        };
+        
+        ::std::vector<DeferredModFiles> pending;
+        pending.push_back( mv$(root_files) );
+        while( pending.size() > 0 )
+        {
+            ::std::vector<Task> tasks;
+            for(const auto& files : pending)
+            {
+                for(const auto& ent : files.ents)
+                {
+                    const auto& placeholder = files.mod->items()[ent.item_idx].data.as_Module();
+                    tasks.push_back( Task { files.mod, &ent, AST::Module(placeholder.path()), {}, { nullptr, {} } } );
+                }
+            }
+            DEBUG(tasks.size() << " module files");
+            
+            parallel_for(tasks.size(), [&](unsigned int i) {
+                auto& t = tasks[i];
+                Token   tok;
+                t.sub_files.mod = &t.mod;
+                
+                Lexer sub_lex(t.ent->file_path);
+                sub_lex.parse_state().deferred_mod_files = &t.sub_files;
+                Parse_ModRoot(sub_lex, t.mod, t.attrs, t.ent->file_controls_dir, t.ent->mod_path);
+                GET_CHECK_TOK(tok, sub_lex, TOK_EOF);
+                });
+            
+            // Move the parsed modules into their placeholders (which are already in declaration order)
+            ::std::vector<DeferredModFiles> next;
+            for(auto& t : tasks)
+            {
+                auto& item = t.parent->items()[t.ent->item_idx].data;
+                for(auto& attr : t.attrs.m_items)
+                    item.attrs.push_back( mv$(attr) );
+                auto& submod = item.as_Module();
+                submod = mv$(t.mod);
+                submod.prescan();
+                
+                if( t.sub_files.ents.size() > 0 )
+                {
+                    t.sub_files.mod = &submod;
+                    next.push_back( mv$(t.sub_files) );
+                }
+            }
+            pending = mv$(next);
+        }
+    }
+}
+
 AST::Crate Parse_Crate(::std::string mainfile)
 {
     Token   tok;
@@ -1720,7 +1824,90 @@ AST::Crate Parse_Crate(::std::string mainfile)
      
     AST::Crate  crate;
 
-    Parse_ModRoot(lex, crate.root_module(), crate.m_attrs, true, mainpath);
+    if( g_parallel_jobs > 1 )
+    {
+        // Module files are only located while parsing their parent, then lexed and parsed as independent tasks
+        DeferredModFiles    deferred { &crate.root_module(), {} };
+        lex.parse_state().deferred_mod_files = &deferred;
+        Parse_ModRoot(lex, crate.root_module(), crate.m_attrs, true, mainpath);
+        lex.parse_state().deferred_mod_files = nullptr;
+        
+        Parse_DeferredModFiles( mv$(deferred) );
+    }
+    else
+    {
+        Parse_ModRoot(lex, crate.root_module(), crate.m_attrs, true, mainpath);
+    }
     
     return crate;
 }
+
+void Parse_CheckCrate(::std::string mainfile, const ::std::string& cache_file)
+{
+    ParseCache  cache { cache_file };
+    cache.load();
+    
+    size_t p = mainfile.find_last_of('/');
+    ::std::string mainpath = (p != ::std::string::npos ? ::std::string(mainfile.begin(), mainfile.begin()+p+1) : "./");
+    
+    struct Task {
+        const ParseCache::ModFile*  file;
+        ParseCache::Hash    content_hash;
+        bool    is_cached;
+        ParseCache::Result  result;
+    };
+    unsigned int    n_files = 0;
+    unsigned int    n_cached = 0;
+    
+    // Visit the module tree a level at a time, parsing changed files in parallel
+    ::std::vector<ParseCache::ModFile>  pending;
+    pending.push_back( ParseCache::ModFile { mainfile, mainpath, true } );
+    while( pending.size() > 0 )
+    {
+        ::std::vector<Task> tasks;
+        for(const auto& f : pending)
+            tasks.push_back( Task { &f, {}, false, {} } );
+        
+        parallel_for(tasks.size(), [&](unsigned int i) {
+            auto& t = tasks[i];
+            // - A file that can't be read is never cached (parsing it reports the error)
+            if( ParseCache::hash_file(t.file->file_path, t.content_hash) )
+            {
+                if( const auto* result = cache.lookup(*t.file, t.content_hash) )
+                {
+                    t.is_cached = true;
+                    t.result = *result;
+                    return ;
+                }
+            }
+            
+            // The parsed module is discarded, so every module file is just recorded instead of being parsed here
+            Token   tok;
+            AST::Module mod { AST::Path("", {}) };
+            AST::MetaItems  attrs;
+            DeferredModFiles    deferred { &mod, {}, true };
+            Lexer lex(t.file->file_path);
+            lex.parse_state().deferred_mod_files = &deferred;
+            Parse_ModRoot(lex, mod, attrs, t.file->file_controls_dir, t.file->mod_path);
+            GET_CHECK_TOK(tok, lex, TOK_EOF);
+            for(auto& ent : deferred.ents)
+                t.result.mod_files.push_back( ParseCache::ModFile { mv$(ent.file_path), mv$(ent.mod_path), ent.file_controls_dir } );
+            for(auto& p : deferred.probes)
+                t.result.probes.push_back( ParseCache::Probe { mv$(p.first), p.second } );
+            });
+        
+        ::std::vector<ParseCache::ModFile>  next;
+        for(auto& t : tasks)
+        {
+            n_files ++;
+            if( t.is_cached )
+                n_cached ++;
+            next.insert( next.end(), t.result.mod_files.begin(), t.result.mod_files.end() );
+            cache.store(*t.file, t.content_hash, mv$(t.result));
+        }
+        pending = mv$(next);
+    }
+    DEBUG(n_files << " files, " << n_cached << " unchanged");
+    
+    cache.save();
+}
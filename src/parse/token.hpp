@@ -46,8 +46,7 @@ namespace AST {
 
 class InterpolatedFragment;
 
-class Token:
-    public Serialisable
+class Token
 {
     TAGGED_UNION(Data, None,
     (None, struct {}),
@@ -67,7 +66,7 @@ class Token:
     Data    m_data;
     Position    m_pos;
 public:
-    virtual ~Token();
+    ~Token();
     Token();
     Token& operator=(Token&& t)
     {
@@ -4,13 +4,12 @@
 #include "lex.hpp"
 #include "../include/serialise.hpp"
 
-class TokenTree:
-    public Serialisable
+class TokenTree
 {
     Token   m_tok;
     ::std::vector<TokenTree>    m_subtrees;
 public:
-    virtual ~TokenTree() {}
+    ~TokenTree() {}
     TokenTree() {}
     TokenTree(TokenTree&&) = default;
     TokenTree& operator=(TokenTree&&) = default;
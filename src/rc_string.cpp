@@ -3,6 +3,7 @@
 #include <rc_string.hpp>
 #include <cstring>
 #include <iostream>
+#include <new>  // placement new
 
 RcString::RcString(const char* s, unsigned int len):
     m_ptr(nullptr),
@@ -11,7 +12,7 @@ RcString::RcString(const char* s, unsigned int len):
     if( len > 0 )
     {
         m_ptr = new unsigned int[1 + (len+1 + sizeof(unsigned int)-1) / sizeof(unsigned int)];
-        *m_ptr = 1;
+        new(m_ptr) ::std::atomic<unsigned int>(1);
         char* data_mut = reinterpret_cast<char*>(m_ptr + 1);
         for(unsigned int j = 0; j < len; j ++ )
             data_mut[j] = s[j];
@@ -22,9 +23,9 @@ RcString::~RcString()
 {
     if(m_ptr)
     {
-        *m_ptr -= 1;
-        //::std::cout << "RcString(\"" << *this << "\") - " << *m_ptr << " refs left" << ::std::endl;
-        if( *m_ptr == 0 )
+        auto refs_left = refcount().fetch_sub(1, ::std::memory_order_acq_rel) - 1;
+        //::std::cout << "RcString(\"" << *this << "\") - " << refs_left << " refs left" << ::std::endl;
+        if( refs_left == 0 )
         {
             delete[] m_ptr;
             m_ptr = nullptr;
@@ -9,6 +9,7 @@
 #include <ast/crate.hpp>
 #include <ast/ast.hpp>
 #include <main_bindings.hpp>
+#include <unordered_map>
 
 struct GenericSlot
 {
@@ -35,6 +36,8 @@ struct Named
     Val value;
 };
 
+namespace {
+
 struct Context
 {
     TAGGED_UNION(Ent, Module,
@@ -44,20 +47,31 @@ struct Context
     (ConcreteSelf, const TypeRef* ),
     (VarBlock, struct {
         unsigned int level;
-        // "Map" of names to function-level variable slots
+        // Names (and function-level variable slots) defined in this block, also present in m_var_names
         ::std::vector< Named< unsigned int > > variables;
         }),
     (Generic, struct {
-        // Map of names to slots
+        // Names (and slots) of the parameters, also present in m_type_names
         ::std::vector< Named< GenericSlot > > types;
-        ::std::vector< Named< GenericSlot > > constants;
-        ::std::vector< Named< GenericSlot > > lifetimes;
         })
     );
+    
+    /// A name bound by a VarBlock/Generic scope
+    struct ScopedBinding {
+        /// Index of the defining scope in m_name_context
+        unsigned int    scope_idx;
+        unsigned int    slot;
+    };
+    /// Map of names to their bindings, innermost last (shadowed bindings are kept until their scope is popped)
+    typedef ::std::unordered_map< ::std::string, ::std::vector<ScopedBinding> >   t_scoped_names;
 
     const ::AST::Crate&     m_crate;
     const ::AST::Module&    m_mod;
     ::std::vector<Ent>  m_name_context;
+    /// Local variables in scope
+    t_scoped_names  m_var_names;
+    /// Generic type parameters in scope
+    t_scoped_names  m_type_names;
     unsigned int m_var_count;
     unsigned int m_block_level;
     bool m_frozen_bind_set;
@@ -89,11 +103,16 @@ struct Context
             //TODO(Span(), "resolve/absolute.cpp - Context::push(GenericParams) - Lifetime params - " << params);
         }
         
+        unsigned int idx = m_name_context.size();
+        for(const auto& t : data.types) {
+            m_type_names[t.name].push_back( ScopedBinding { idx, t.value.to_binding() } );
+        }
         m_name_context.push_back(mv$(e));
     }
     void pop(const ::AST::GenericParams& , bool has_self=false) {
         if( !m_name_context.back().is_Generic() )
             BUG(Span(), "resolve/absolute.cpp - Context::pop(GenericParams) - Mismatched pop");
+        unbind_scoped(m_type_names, m_name_context.back().as_Generic().types);
         m_name_context.pop_back();
         if(has_self) {
             if( !m_name_context.back().is_ConcreteSelf() )
@@ -197,6 +216,7 @@ struct Context
             auto& vb = m_name_context.back().as_VarBlock();
             assert(vb.level == m_block_level);
             vb.variables.push_back( Named<unsigned int> { name, m_var_count } );
+            m_var_names[name].push_back( ScopedBinding { static_cast<unsigned int>(m_name_context.size() - 1), m_var_count } );
             m_var_count += 1;
             assert( m_var_count >= vb.variables.size() );
             return m_var_count - 1;
@@ -209,6 +229,7 @@ struct Context
                 for(const auto& v : m_name_context.back().as_VarBlock().variables)
                     os << " " << v.name << "#" << v.value;
                 ));
+            unbind_scoped(m_var_names, m_name_context.back().as_VarBlock().variables);
             m_name_context.pop_back();
         }
         else {
@@ -223,6 +244,27 @@ struct Context
         m_block_level -= 1;
     }
     
+    /// Remove the bindings of a scope that is being popped
+    template<typename T>
+    void unbind_scoped(t_scoped_names& names, const ::std::vector< Named<T> >& scope_names) {
+        for(auto it = scope_names.rbegin(); it != scope_names.rend(); ++ it)
+        {
+            auto e = names.find(it->name);
+            assert( e != names.end() );
+            assert( e->second.size() > 0 && e->second.back().scope_idx == m_name_context.size() - 1 );
+            e->second.pop_back();
+            if( e->second.empty() )
+                names.erase(e);
+        }
+    }
+    /// Get the innermost binding of a name (or nullptr)
+    static const ScopedBinding* find_scoped(const t_scoped_names& names, const ::std::string& name) {
+        auto it = names.find(name);
+        if( it == names.end() )
+            return nullptr;
+        return &it->second.back();
+    }
+    
     /// Indicate that a multiple-pattern binding is started
     void start_patbind() {
         assert( m_block_level > 0 );
@@ -276,19 +318,13 @@ struct Context
         switch(mode)
         {
         case LookupMode::Namespace:
-            {
-                auto v = mod.m_namespace_items.find(name);
-                if( v != mod.m_namespace_items.end() ) {
-                    path = ::AST::Path( v->second.path );
-                    return true;
-                }
+            if( const auto* v = mod.find_namespace_item(name) ) {
+                path = ::AST::Path( v->path );
+                return true;
             }
-            {
-                auto v = mod.m_type_items.find(name);
-                if( v != mod.m_type_items.end() ) {
-                    path = ::AST::Path( v->second.path );
-                    return true;
-                }
+            if( const auto* v = mod.find_type_item(name) ) {
+                path = ::AST::Path( v->path );
+                return true;
             }
             break;
         
@@ -299,62 +335,60 @@ struct Context
             //        DEBUG("- " << v.first << " = " << (v.second.is_pub ? "pub " : "") << v.second.path);
             //    }
             //}
-            {
-                auto v = mod.m_type_items.find(name);
-                if( v != mod.m_type_items.end() ) {
-                    path = ::AST::Path( v->second.path );
-                    return true;
-                }
+            if( const auto* v = mod.find_type_item(name) ) {
+                path = ::AST::Path( v->path );
+                return true;
             }
             break;
         case LookupMode::Pattern:
-            {
-                auto v = mod.m_type_items.find(name);
-                if( v != mod.m_type_items.end() ) {
-                    const auto& b = v->second.path.binding();
-                    switch( b.tag() )
-                    {
-                    case ::AST::PathBinding::TAG_Struct:
-                        path = ::AST::Path( v->second.path );
-                        return true;
-                    default:
-                        break;
-                    }
+            if( const auto* v = mod.find_type_item(name) ) {
+                const auto& b = v->path.binding();
+                switch( b.tag() )
+                {
+                case ::AST::PathBinding::TAG_Struct:
+                    path = ::AST::Path( v->path );
+                    return true;
+                default:
+                    break;
                 }
             }
-            {
-                auto v = mod.m_value_items.find(name);
-                if( v != mod.m_value_items.end() ) {
-                    const auto& b = v->second.path.binding();
-                    switch( b.tag() )
-                    {
-                    case ::AST::PathBinding::TAG_EnumVar:
-                    case ::AST::PathBinding::TAG_Static:
-                        path = ::AST::Path( v->second.path );
-                        return true;
-                    default:
-                        break;
-                    }
+            if( const auto* v = mod.find_value_item(name) ) {
+                const auto& b = v->path.binding();
+                switch( b.tag() )
+                {
+                case ::AST::PathBinding::TAG_EnumVar:
+                case ::AST::PathBinding::TAG_Static:
+                    path = ::AST::Path( v->path );
+                    return true;
+                default:
+                    break;
                 }
             }
             break;
         case LookupMode::Constant:
         case LookupMode::Variable:
-            {
-                auto v = mod.m_value_items.find(name);
-                if( v != mod.m_value_items.end() ) {
-                    path = ::AST::Path( v->second.path );
-                    return true;
-                }
+            if( const auto* v = mod.find_value_item(name) ) {
+                path = ::AST::Path( v->path );
+                return true;
             }
             break;
         }
         return false;
     }
     AST::Path lookup_opt(const ::std::string& name, LookupMode mode) const {
-        for(auto it = m_name_context.rbegin(); it != m_name_context.rend(); ++ it)
+        // Locals (variables and generic types) are looked up directly, only the scopes above the binding need checking
+        const ScopedBinding* local = nullptr;
+        if( mode == LookupMode::Variable ) {
+            local = find_scoped(m_var_names, name);
+        }
+        else if( mode == LookupMode::Type || mode == LookupMode::Namespace ) {
+            local = find_scoped(m_type_names, name);
+        }
+        unsigned int stop_idx = (local ? local->scope_idx + 1 : 0);
+        
+        for(unsigned int i = m_name_context.size(); i -- > stop_idx; )
         {
-            TU_MATCH(Ent, (*it), (e),
+            TU_MATCH(Ent, (m_name_context[i]), (e),
             (Module,
                 ::AST::Path rv;
                 if( this->lookup_in_mod(*e.mod, name, mode,  rv) ) {
@@ -368,38 +402,17 @@ struct Context
                 ),
             (VarBlock,
                 assert(e.level <= m_block_level);
-                if( mode != LookupMode::Variable ) {
-                    // ignore
-                }
-                else {
-                    for( auto it2 = e.variables.rbegin(); it2 != e.variables.rend(); ++ it2 )
-                    {
-                        if( it2->name == name ) {
-                            ::AST::Path rv(name);
-                            rv.bind_variable( it2->value );
-                            return rv;
-                        }
-                    }
-                }
                 ),
             (Generic,
-                if( mode == LookupMode::Type || mode == LookupMode::Namespace ) {
-                    for( auto it2 = e.types.rbegin(); it2 != e.types.rend(); ++ it2 )
-                    {
-                        if( it2->name == name ) {
-                            ::AST::Path rv(name);
-                            rv.bind_variable( it2->value.to_binding() );
-                            return rv;
-                        }
-                    }
-                }
-                else {
-                    // ignore.
-                    // TODO: Integer generics
-                }
+                // TODO: Integer generics
                 )
             )
         }
+        if( local ) {
+            ::AST::Path rv(name);
+            rv.bind_variable( local->slot );
+            return rv;
+        }
         
         // Top-level module
         ::AST::Path rv;
@@ -418,38 +431,19 @@ struct Context
     }
 
     unsigned int lookup_local(const Span& sp, const ::std::string name, LookupMode mode) {
-        for(auto it = m_name_context.rbegin(); it != m_name_context.rend(); ++ it)
-        {
-            TU_MATCH(Ent, (*it), (e),
-            (Module,
-                ),
-            (ConcreteSelf,
-                ),
-            (VarBlock,
-                if( mode == LookupMode::Variable ) {
-                    for( auto it2 = e.variables.rbegin(); it2 != e.variables.rend(); ++ it2 )
-                    {
-                        if( it2->name == name ) {
-                            return it2->value;
-                        }
-                    }
-                }
-                ),
-            (Generic,
-                if( mode == LookupMode::Type ) {
-                    for( auto it2 = e.types.rbegin(); it2 != e.types.rend(); ++ it2 )
-                    {
-                        if( it2->name == name ) {
-                            return it2->value.to_binding();
-                        }
-                    }
-                }
-                else {
-                    // ignore.
-                    // TODO: Integer generics
-                }
-                )
-            )
+        const ScopedBinding* local = nullptr;
+        if( mode == LookupMode::Variable ) {
+            local = find_scoped(m_var_names, name);
+        }
+        else if( mode == LookupMode::Type ) {
+            local = find_scoped(m_type_names, name);
+        }
+        else {
+            // ignore.
+            // TODO: Integer generics
+        }
+        if( local ) {
+            return local->slot;
         }
         
         ERROR(sp, E0000, "Unable to find local " << (mode == LookupMode::Variable ? "variable" : "type") << " '" << name << "'");
@@ -479,6 +473,8 @@ struct Context
     return os;
 }
 
+}   // namespace
+
 
 
 void Resolve_Absolute_Path(/*const*/ Context& context, const Span& sp, Context::LookupMode mode,  ::AST::Path& path);
@@ -629,11 +625,11 @@ void Resolve_Absolute_Path_BindAbsolute(Context& context, const Span& sp, Contex
         }
         else
         {
-            auto it = mod->m_namespace_items.find( n.name() );
-            if( it == mod->m_namespace_items.end() ) {
+            const auto* name_ref_p = mod->find_namespace_item( n.name() );
+            if( !name_ref_p ) {
                 ERROR(sp, E0000, "Couldn't find path component '" << n.name() << "' of " << path);
             }
-            const auto& name_ref = it->second;
+            const auto& name_ref = *name_ref_p;
             DEBUG("#" << i << " \"" << n.name() << "\" = " << name_ref.path << (name_ref.is_import ? " (import)" : "") );
             
             TU_MATCH_DEF(::AST::PathBinding, (name_ref.path.binding()), (e),
@@ -228,23 +228,9 @@ void Resolve_Index_Module_Wildcard(AST::Module& mod, bool handle_pub)
                 if( e.module_ == &mod ) {
                     ERROR(sp, E0000, "Glob import of self");
                 }
-                // 1. Begin indexing of this module if it is not already indexed
-                if( e.module_->m_index_populated == 1 )
-                {
-                    // TODO: Handle wildcard import of a module with a public wildcard import
-                    TODO(sp, "Handle wildcard import of module with a wildcard (" << e.module_->path() << " by " << mod.path() << ")");
-                    //Resolve_Index_Module( *e.module_ );
-                }
-                for(const auto& vi : e.module_->m_type_items) {
-                    if( vi.second.is_pub ) {
-                        _add_item_type( sp, mod, vi.first, i.is_pub, vi.second.path, false );
-                    }
-                }
-                for(const auto& vi : e.module_->m_value_items) {
-                    if( vi.second.is_pub ) {
-                        _add_item_value( sp, mod, vi.first, i.is_pub, vi.second.path, false );
-                    }
-                }
+                // Referenced instead of copied, lookups (Module::find_*_item) search the imported module's index
+                // after this module's own items (so works even if that module's globs haven't been indexed yet)
+                mod.m_glob_imports.push_back( ::AST::Module::GlobImport { i.is_pub, e.module_ } );
                 ),
             (Enum,
                 DEBUG("Glob enum " << i.data.path);
@@ -299,12 +285,12 @@ void Resolve_Index_Module_Normalise_Path(const ::AST::Crate& crate, const Span&
         bool is_last = (i == info.nodes.size() - 1);
         
         if( is_last ) {
-            auto it = mod->m_namespace_items.find( node.name() );
-            if( it == mod->m_namespace_items.end() )
-                it = mod->m_value_items.find( node.name() );
-            if( it == mod->m_value_items.end() )
+            const auto* iep = mod->find_namespace_item( node.name() );
+            if( !iep )
+                iep = mod->find_value_item( node.name() );
+            if( !iep )
                 ERROR(sp, E0000,  "Couldn't find final node of path " << path);
-            const auto& ie = it->second;
+            const auto& ie = *iep;
             
             if( ie.is_import ) {
                 // TODO: Prevent infinite recursion if the user does something dumb
@@ -316,10 +302,10 @@ void Resolve_Index_Module_Normalise_Path(const ::AST::Crate& crate, const Span&
             }
         }
         else {
-            auto it = mod->m_namespace_items.find( node.name() );
-            if( it == mod->m_namespace_items.end() )
+            const auto* iep = mod->find_namespace_item( node.name() );
+            if( !iep )
                 ERROR(sp, E0000,  "Couldn't find node " << i << " of path " << path);
-            const auto& ie = it->second;
+            const auto& ie = *iep;
             
             if( ie.is_import ) {
                 TODO(sp, "Replace imports");
@@ -5,20 +5,10 @@
 #include <serialiser_texttree.hpp>
 #include "common.hpp"
 
-Serialiser& Serialiser::operator<<(const Serialisable& subobj)
+void Deserialiser::start_object_tagged(const char *tag)
 {
-    start_object(subobj.serialise_tag());
-    subobj.serialise(*this);
-    end_object(subobj.serialise_tag());
-    return *this;
-}
-
-void Deserialiser::item(Serialisable& s)
-{
-    DEBUG("Deserialise - '"<<s.serialise_tag()<<"'");
-    start_object(s.serialise_tag());
-    s.deserialise(*this);
-    end_object(s.serialise_tag());
+    DEBUG("Deserialise - '"<<tag<<"'");
+    start_object(tag);
 }
 ::std::string Deserialiser::start_object()
 {
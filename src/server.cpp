@@ -0,0 +1,304 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * server.cpp
+ * - Compile server (serves compilations over a local socket)
+ *
+ * One request per connection:
+ * - The client sends a `uint32_t` payload length, with its stdout and stderr attached (SCM_RIGHTS)
+ * - Then the payload: the working directory followed by each argument, all NUL terminated
+ * - Once the compile finishes the server replies with its `int32_t` exit code (the connection closing without a reply
+ *   means that the compiler died)
+ */
+#include <server.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace {
+    /// Upper limit on the size of a request (guards against garbage on the socket)
+    const uint32_t MAX_REQUEST_SIZE = 1 << 20;
+    /// Socket created by `Server_Run` (removed when the server is stopped by a signal)
+    char    s_socket_path[sizeof(sockaddr_un::sun_path)];
+
+    void handle_stop_signal(int sig)
+    {
+        ::unlink(s_socket_path);
+        ::_exit(128 + sig);
+    }
+
+    bool write_all(int fd, const void* data, size_t len)
+    {
+        const char* p = static_cast<const char*>(data);
+        while( len > 0 )
+        {
+            auto rv = ::write(fd, p, len);
+            if( rv < 0 && errno == EINTR )
+                continue ;
+            if( rv <= 0 )
+                return false;
+            p += rv;
+            len -= rv;
+        }
+        return true;
+    }
+    bool read_all(int fd, void* data, size_t len)
+    {
+        char* p = static_cast<char*>(data);
+        while( len > 0 )
+        {
+            auto rv = ::read(fd, p, len);
+            if( rv < 0 && errno == EINTR )
+                continue ;
+            if( rv <= 0 )
+                return false;
+            p += rv;
+            len -= rv;
+        }
+        return true;
+    }
+
+    /// Prepare to bind `socket_path`, removing a stale socket left by a previous server
+    /// - Anything that isn't a socket is left alone (e.g. a source file passed to `--server` by mistake)
+    bool remove_stale_socket(const char* socket_path, const struct sockaddr_un& addr)
+    {
+        struct stat st;
+        if( ::stat(socket_path, &st) != 0 )
+            return true;
+        if( !S_ISSOCK(st.st_mode) ) {
+            ::std::cerr << socket_path << " exists and is not a socket" << ::std::endl;
+            return false;
+        }
+        int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = probe >= 0 && ::connect(probe, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) == 0;
+        if( probe >= 0 )
+            ::close(probe);
+        if( live ) {
+            ::std::cerr << "A compile server is already listening on " << socket_path << ::std::endl;
+            return false;
+        }
+        ::unlink(socket_path);
+        return true;
+    }
+
+    bool make_address(const char* socket_path, struct sockaddr_un& addr)
+    {
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if( strlen(socket_path) >= sizeof(addr.sun_path) ) {
+            ::std::cerr << "Socket path too long: " << socket_path << ::std::endl;
+            return false;
+        }
+        strcpy(addr.sun_path, socket_path);
+        return true;
+    }
+
+    /// Read a request and run it (called in the forked child), returns the exit code
+    int handle_request(int conn, FunctionRef<int(int, char**)> handler)
+    {
+        // - Header, carrying the client's stdout/stderr
+        uint32_t    len = 0;
+        int fds[2] = { -1, -1 };
+        {
+            struct iovec    iov;
+            iov.iov_base = &len;
+            iov.iov_len = sizeof(len);
+            union {
+                struct cmsghdr  hdr;
+                char    buf[CMSG_SPACE(sizeof(fds))];
+            } control;
+            struct msghdr   msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control.buf;
+            msg.msg_controllen = sizeof(control.buf);
+            if( ::recvmsg(conn, &msg, 0) != sizeof(len) )
+                return 1;
+            auto* cmsg = CMSG_FIRSTHDR(&msg);
+            if( !cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(fds)) )
+                return 1;
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+        }
+        // - Output goes straight to the client
+        ::dup2(fds[0], 1);
+        ::dup2(fds[1], 2);
+        ::close(fds[0]);
+        ::close(fds[1]);
+
+        // - Payload: working directory and arguments
+        if( len > MAX_REQUEST_SIZE ) {
+            ::std::cerr << "Compile request too large (" << len << " bytes)" << ::std::endl;
+            return 1;
+        }
+        ::std::string   payload(len, '\0');
+        if( !read_all(conn, &payload[0], len) )
+            return 1;
+        ::std::vector< ::std::string>   parts;
+        for(size_t pos = 0; pos < payload.size(); )
+        {
+            auto end = payload.find('\0', pos);
+            if( end == ::std::string::npos )
+                return 1;
+            parts.push_back( payload.substr(pos, end - pos) );
+            pos = end + 1;
+        }
+        if( parts.empty() )
+            return 1;
+
+        if( ::chdir(parts[0].c_str()) != 0 ) {
+            ::std::cerr << "Unable to change to directory " << parts[0] << ": " << strerror(errno) << ::std::endl;
+            return 1;
+        }
+        ::std::vector<char*>    argv;
+        argv.push_back( const_cast<char*>("mrustc") );
+        for(size_t i = 1; i < parts.size(); i ++)
+            argv.push_back( &parts[i][0] );
+        argv.push_back( nullptr );
+        return handler(static_cast<int>(argv.size() - 1), argv.data());
+    }
+}
+
+int Server_Run(const char* socket_path, FunctionRef<int(int argc, char* argv[])> handler)
+{
+    struct sockaddr_un  addr;
+    if( !make_address(socket_path, addr) )
+        return 1;
+    if( !remove_stale_socket(socket_path, addr) )
+        return 1;
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if( sock < 0 ) {
+        ::std::cerr << "Unable to create socket: " << strerror(errno) << ::std::endl;
+        return 1;
+    }
+    if( ::bind(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ) {
+        ::std::cerr << "Unable to listen on " << socket_path << ": " << strerror(errno) << ::std::endl;
+        ::close(sock);
+        return 1;
+    }
+    if( ::listen(sock, 64) != 0 ) {
+        ::std::cerr << "Unable to listen on " << socket_path << ": " << strerror(errno) << ::std::endl;
+        ::close(sock);
+        ::unlink(socket_path);
+        return 1;
+    }
+    // The server normally runs until killed, so remove the socket on the way out
+    strcpy(s_socket_path, addr.sun_path);
+    ::signal(SIGINT, handle_stop_signal);
+    ::signal(SIGTERM, handle_stop_signal);
+    ::signal(SIGHUP, handle_stop_signal);
+    // Finished requests are reaped automatically
+    ::signal(SIGCHLD, SIG_IGN);
+    ::std::cout << "Listening on " << socket_path << ::std::endl;
+
+    for(;;)
+    {
+        int conn = ::accept(sock, nullptr, nullptr);
+        if( conn < 0 ) {
+            if( errno == EINTR )
+                continue ;
+            ::std::cerr << "Unable to accept connection: " << strerror(errno) << ::std::endl;
+            ::close(sock);
+            ::unlink(socket_path);
+            return 1;
+        }
+        // Flush before forking, so buffered output isn't duplicated into the child
+        ::std::cout.flush();
+        ::fflush(nullptr);
+
+        auto pid = ::fork();
+        if( pid == 0 )
+        {
+            ::close(sock);
+            ::signal(SIGCHLD, SIG_DFL);
+            ::signal(SIGINT, SIG_DFL);
+            ::signal(SIGTERM, SIG_DFL);
+            ::signal(SIGHUP, SIG_DFL);
+            int32_t rv = handle_request(conn, handler);
+            ::std::cout.flush();
+            ::std::cerr.flush();
+            ::fflush(nullptr);
+            write_all(conn, &rv, sizeof(rv));
+            ::_exit(rv);
+        }
+        if( pid < 0 ) {
+            ::std::cerr << "Unable to fork for request: " << strerror(errno) << ::std::endl;
+        }
+        ::close(conn);
+    }
+}
+
+int Server_Client(const char* socket_path, int argc, char* argv[])
+{
+    struct sockaddr_un  addr;
+    if( !make_address(socket_path, addr) )
+        return 1;
+    // A server that drops the connection shows up as a failed write (reported below) instead of killing this process
+    ::signal(SIGPIPE, SIG_IGN);
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if( sock < 0 || ::connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ) {
+        ::std::cerr << "Unable to connect to compile server at " << socket_path << ": " << strerror(errno) << ::std::endl;
+        return 1;
+    }
+
+    char    cwd[PATH_MAX];
+    if( !::getcwd(cwd, sizeof(cwd)) ) {
+        ::std::cerr << "Unable to get working directory: " << strerror(errno) << ::std::endl;
+        return 1;
+    }
+    ::std::string   payload = cwd;
+    payload += '\0';
+    for(int i = 0; i < argc; i ++)
+    {
+        payload += argv[i];
+        payload += '\0';
+    }
+
+    // - Header, carrying this process's stdout/stderr
+    uint32_t    len = static_cast<uint32_t>(payload.size());
+    int fds[2] = { 1, 2 };
+    struct iovec    iov;
+    iov.iov_base = &len;
+    iov.iov_len = sizeof(len);
+    union {
+        struct cmsghdr  hdr;
+        char    buf[CMSG_SPACE(sizeof(fds))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct msghdr   msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    auto* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if( ::sendmsg(sock, &msg, 0) != sizeof(len) || !write_all(sock, payload.data(), payload.size()) ) {
+        ::std::cerr << "Unable to send compile request: " << strerror(errno) << ::std::endl;
+        ::close(sock);
+        return 1;
+    }
+
+    int32_t rv;
+    if( !read_all(sock, &rv, sizeof(rv)) ) {
+        ::std::cerr << "Compile server closed the connection without a result" << ::std::endl;
+        rv = 1;
+    }
+    ::close(sock);
+    return rv;
+}
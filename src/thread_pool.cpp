@@ -0,0 +1,120 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * thread_pool.cpp
+ * - Work-stealing pool for running independent tasks in parallel
+ */
+#include <thread_pool.hpp>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <exception>
+#include <memory>
+
+unsigned int g_parallel_jobs = 1;
+
+namespace {
+    /// Range of task indexes owned by one worker
+    struct WorkRange
+    {
+        ::std::mutex    lock;
+        unsigned int    start = 0;
+        unsigned int    end = 0;
+        
+        /// Take the next index from the front (used by the owning worker)
+        bool pop(unsigned int& out_idx) {
+            ::std::lock_guard< ::std::mutex>    _(lock);
+            if( start == end )
+                return false;
+            out_idx = start ++;
+            return true;
+        }
+        /// Take the back half of the remaining range (used by other workers)
+        bool steal(unsigned int& out_start, unsigned int& out_end) {
+            ::std::lock_guard< ::std::mutex>    _(lock);
+            unsigned int remaining = end - start;
+            if( remaining == 0 )
+                return false;
+            unsigned int count = (remaining + 1) / 2;
+            out_start = end - count;
+            out_end = end;
+            end = out_start;
+            return true;
+        }
+        void set(unsigned int new_start, unsigned int new_end) {
+            ::std::lock_guard< ::std::mutex>    _(lock);
+            start = new_start;
+            end = new_end;
+        }
+    };
+}
+
+void parallel_for(unsigned int count, FunctionRef<void(unsigned int)> task)
+{
+    unsigned int n_threads = g_parallel_jobs;
+    if( n_threads > count )
+        n_threads = count;
+    if( n_threads <= 1 )
+    {
+        for(unsigned int i = 0; i < count; i ++)
+            task(i);
+        return ;
+    }
+    
+    ::std::unique_ptr<WorkRange[]>  ranges { new WorkRange[n_threads] };
+    for(unsigned int i = 0; i < n_threads; i ++)
+        ranges[i].set( static_cast<unsigned int>(static_cast<unsigned long long>(count) * i / n_threads), static_cast<unsigned int>(static_cast<unsigned long long>(count) * (i+1) / n_threads) );
+    
+    ::std::atomic<bool> failed { false };
+    ::std::mutex    error_lock;
+    ::std::exception_ptr    error;
+    
+    auto worker = [&](unsigned int self) {
+        try
+        {
+            for(;;)
+            {
+                unsigned int idx;
+                while( !failed && ranges[self].pop(idx) )
+                {
+                    task(idx);
+                }
+                if( failed )
+                    break;
+                
+                // Own range exhausted, steal from another worker (starting with the next one along)
+                bool stolen = false;
+                for(unsigned int ofs = 1; ofs < n_threads && !stolen; ofs ++)
+                {
+                    unsigned int s, e;
+                    if( ranges[(self + ofs) % n_threads].steal(s, e) ) {
+                        ranges[self].set(s, e);
+                        stolen = true;
+                    }
+                }
+                if( !stolen )
+                    break;
+            }
+        }
+        catch(...)
+        {
+            ::std::lock_guard< ::std::mutex>    _(error_lock);
+            if( !error )
+                error = ::std::current_exception();
+            failed = true;
+        }
+    };
+    
+    ::std::vector< ::std::thread>   threads;
+    threads.reserve(n_threads - 1);
+    for(unsigned int i = 1; i < n_threads; i ++)
+        threads.push_back( ::std::thread(worker, i) );
+    worker(0);
+    for(auto& t : threads)
+        t.join();
+    
+    if( error )
+        ::std::rethrow_exception(error);
+}